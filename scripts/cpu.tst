@@ -414,3 +414,36 @@ TEST 'A=15 A;JGT' {
 }
 
 
+TEST 'A=5 with TICK' {
+	VAR c: cpu;
+	REQUIRE c.pc IS 0;
+	SET c.instruction = 5;
+	TICK;
+	REQUIRE c.pc IS 1
+		AND c.d_reg IS 0
+		AND c.addressM IS 5;
+}
+
+TEST 'A=15 D=A A=7 D=D-A with TICK' {
+	VAR c: cpu;
+	SET c.instruction = 15;
+	TICK;
+	SET c.instruction = 60432;
+	TICK;
+	REQUIRE c.d_reg IS 15 AND c.pc IS 2;
+	SET c.instruction = 7;
+	TICK;
+	SET c.instruction = 58576;
+	TICK;
+	REQUIRE c.addressM IS 7 AND c.d_reg IS 8 AND c.pc IS 4;
+}
+
+TEST 'reset with TICK' {
+	VAR c: cpu;
+	SET c.instruction = 5;
+	TICK 1000;
+	REQUIRE c.pc IS 1000;
+	SET c.reset = 1;
+	TICK;
+	REQUIRE c.pc IS 0;
+}
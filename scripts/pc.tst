@@ -103,3 +103,42 @@ TEST 'load, inc, reset' {
 	REQUIRE p.out IS 0;
 	
 }
+
+TEST 'inc with TICK' {
+	VAR p: pc;
+	SET p.inc = 1;
+	TICK;
+	REQUIRE p.out IS 1;
+	TICK 4;
+	REQUIRE p.out IS 5;
+
+	// Held while no flag is set.
+	SET p.inc = 0;
+	TICK 2;
+	REQUIRE p.out IS 5;
+}
+
+TEST 'reset, inc, load priority with TICK' {
+	VAR p: pc;
+
+	SET p.in = 300;
+	SET p.load = 1;
+	TICK;
+	REQUIRE p.out IS 300;
+
+	// inc wins over load.
+	SET p.in = 1000;
+	SET p.inc = 1;
+	TICK;
+	REQUIRE p.out IS 301;
+
+	// reset wins over both.
+	SET p.reset = 1;
+	TICK;
+	REQUIRE p.out IS 0;
+
+	SET p.reset = 0;
+	SET p.inc = 0;
+	TICK;
+	REQUIRE p.out IS 1000;
+}
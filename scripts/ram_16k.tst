@@ -51,3 +51,33 @@ TEST 'loading and setting values' {
 	REQUIRE r.out IS 3889;
 }
 
+
+TEST 'write then read with TICK' {
+	VAR r: ram_16k;
+
+	// Written on the edge, at the address of the edge.
+	SET r.address = 3;
+	SET r.in = 3889;
+	SET r.load = 1;
+	TICK;
+	REQUIRE r.out IS 3889;
+
+	SET r.address = 16383;
+	SET r.in = 1734;
+	TICK;
+
+	// Reading only needs the address to settle.
+	SET r.load = 0;
+	SET r.in = 0;
+	SET r.address = 3;
+	EVAL;
+	REQUIRE r.out IS 3889;
+
+	SET r.address = 16383;
+	EVAL;
+	REQUIRE r.out IS 1734;
+
+	// Held while load is off.
+	TICK 2;
+	REQUIRE r.out IS 1734;
+}
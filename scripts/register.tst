@@ -42,3 +42,28 @@ TEST 'storing a register' {
 	EVAL;
 	REQUIRE b.out IS 65535;
 }
+
+TEST 'load and hold with TICK' {
+	VAR b: register;
+
+	// Load is off, the clock edge keeps the value.
+	SET b.in = 2847;
+	TICK;
+	REQUIRE b.out IS 0;
+
+	// Nothing changes before the edge.
+	SET b.load = 1;
+	REQUIRE b.out IS 0;
+	TICK;
+	REQUIRE b.out IS 2847;
+
+	// Held over several cycles while load is off.
+	SET b.load = 0;
+	SET b.in = 65535;
+	TICK 3;
+	REQUIRE b.out IS 2847;
+
+	SET b.load = 1;
+	TICK;
+	REQUIRE b.out IS 65535;
+}
@@ -0,0 +1,46 @@
+LOAD sr_latch;
+
+TEST 'set, hold, reset, hold' {
+	VAR l: sr_latch;
+
+	// Inputs are active low, pulling s low sets the latch.
+	SET l.s = 0;
+	SET l.r = 1;
+	EVAL;
+	REQUIRE l.q IS 1 AND l.nq IS 0;
+
+	// Both high, the loop settles on what it held.
+	SET l.s = 1;
+	EVAL;
+	REQUIRE l.q IS 1 AND l.nq IS 0;
+	EVAL;
+	REQUIRE l.q IS 1 AND l.nq IS 0;
+
+	// Reset.
+	SET l.r = 0;
+	EVAL;
+	REQUIRE l.q IS 0 AND l.nq IS 1;
+
+	SET l.r = 1;
+	EVAL;
+	REQUIRE l.q IS 0 AND l.nq IS 1;
+}
+
+TEST 'set and reset with TICK' {
+	VAR l: sr_latch;
+
+	SET l.s = 0;
+	SET l.r = 1;
+	TICK;
+	REQUIRE l.q IS 1 AND l.nq IS 0;
+
+	SET l.s = 1;
+	TICK 2;
+	REQUIRE l.q IS 1 AND l.nq IS 0;
+
+	SET l.r = 0;
+	TICK;
+	SET l.r = 1;
+	TICK;
+	REQUIRE l.q IS 0 AND l.nq IS 1;
+}
@@ -0,0 +1,285 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gate.hpp"
+#include "pin.hpp"
+#include "netlist/thread_pool.hpp"
+
+/**
+ * Many independent instances of one chip, each fed its own stream of input vectors.
+ * The instances share the chip's profile (see ChipProfile), only their pin planes
+ * and simulation state are their own, so thousands of them fit where thousands of
+ * freshly built chips wouldn't.
+ */
+namespace batch
+{
+
+/**
+ * Pin states of one instance over time, one row per step. A row uses the layout of
+ * the gate's pin planes, so stepping an instance copies words instead of pins.
+ */
+class Waveform
+{
+public:
+  explicit Waveform(std::size_t width)
+    : pin_count(width)
+    , row_words(plane_words(width))
+  {
+  }
+
+  auto width() const -> std::size_t
+  {
+    return pin_count;
+  }
+
+  auto steps() const -> std::size_t
+  {
+    return step_count;
+  }
+
+  auto row(std::size_t step) -> PinWord*
+  {
+    return words.data() + step * row_words;
+  }
+
+  auto row(std::size_t step) const -> const PinWord*
+  {
+    return words.data() + step * row_words;
+  }
+
+  auto add_row() -> PinWord*
+  {
+    step_count++;
+    words.resize(words.size() + row_words, 0);
+    return row(step_count - 1);
+  }
+
+  auto reserve(std::size_t steps) -> void
+  {
+    words.reserve(steps * row_words);
+  }
+
+  auto get(std::size_t step, std::size_t pin) const -> bool
+  {
+    return plane_extract(row(step), pin, pin + 1) != 0;
+  }
+
+  auto set(std::size_t step, std::size_t pin, bool value) -> void
+  {
+    plane_insert(row(step), value, pin, pin + 1);
+  }
+
+private:
+  std::size_t          pin_count{};
+  std::size_t          row_words{};
+  std::size_t          step_count{};
+  std::vector<PinWord> words{};
+};
+
+/**
+ * Run every stimulus on an instance of its own, spread over all cores. Each step
+ * drives the inputs with a row of the stimulus and records the settled outputs, the
+ * instances keep their state from one step to the next like a chip on the board.
+ *
+ * The chip has to be finished (serialized or flattened) or a built-in, only those
+ * can be instantiated from several threads at once. Returns the outputs, one
+ * waveform per stimulus, or nothing if the chip can't run as a batch.
+ *
+ * threads: Threads to use, 0 to use the shared pool (one thread per core).
+ */
+inline auto run(Gate& chip, const std::vector<Waveform>& stimuli, std::size_t threads = 0) -> std::optional<std::vector<Waveform>>
+{
+  // Build the profile up front, the instances only ever read it.
+  if (chip.type == GateType::CUSTOM && chip.get_profile() == nullptr)
+  {
+    return std::nullopt;
+  }
+
+  const auto input_count = chip.input_pins.size();
+  const auto output_count = chip.output_pins.size();
+
+  for (const auto& stimulus : stimuli)
+  {
+    if (stimulus.width() != input_count) return std::nullopt;
+  }
+
+  std::vector<Waveform> results(stimuli.size(), Waveform(output_count));
+
+  const auto run_instance = [&](std::size_t index)
+  {
+    const auto& stimulus = stimuli[index];
+    auto& result = results[index];
+    auto instance = chip.duplicate();
+
+    const auto input_words = plane_words(instance->input_pins.size());
+    const auto output_words = instance->output_plane.size();
+    result.reserve(stimulus.steps());
+
+    for (std::size_t step = 0; step < stimulus.steps(); step++)
+    {
+      std::copy_n(stimulus.row(step), input_words, instance->input_plane.data());
+      instance->simulate();
+      std::copy_n(instance->output_plane.data(), output_words, result.add_row());
+    }
+  };
+
+  if (threads == 0)
+  {
+    netlist::ThreadPool::shared().parallel_for(stimuli.size(), run_instance);
+  }
+  else
+  {
+    netlist::ThreadPool(threads).parallel_for(stimuli.size(), run_instance);
+  }
+
+  return results;
+}
+
+/**
+ * Read the stimuli of a batch. Every line holds the input bits of one step, first
+ * pin first, blank lines separate the instances and '//' starts a comment:
+ *
+ *   // instance 0
+ *   0011
+ *   0101
+ *
+ *   // instance 1
+ *   1111
+ *
+ * Spaces and underscores between bits are ignored. Returns nothing if the file
+ * can't be read or a line has the wrong number of bits, error tells which.
+ */
+inline auto read_stimuli(const std::string& path, std::size_t width, std::string& error) -> std::optional<std::vector<Waveform>>
+{
+  std::ifstream file(path);
+
+  if (!file.is_open())
+  {
+    error = "Unable to open `" + path + "`.";
+    return std::nullopt;
+  }
+
+  std::vector<Waveform> stimuli{};
+  bool new_instance = true;
+  std::string line{};
+  std::size_t line_number = 0;
+
+  while (std::getline(file, line))
+  {
+    line_number++;
+
+    if (const auto comment = line.find("//"); comment != std::string::npos)
+    {
+      // A comment on a line of its own doesn't end the instance.
+      if (line.find_first_not_of(" \t\r") == comment) continue;
+      line.erase(comment);
+    }
+
+    std::string bits{};
+    for (const char c : line)
+    {
+      if (c == '0' || c == '1') bits += c;
+      else if (c != ' ' && c != '\t' && c != '_' && c != '\r')
+      {
+        error = "Line " + std::to_string(line_number) + ": unexpected character `" + c + "`.";
+        return std::nullopt;
+      }
+    }
+
+    if (bits.empty())
+    {
+      new_instance = true;
+      continue;
+    }
+
+    if (bits.size() != width)
+    {
+      error = "Line " + std::to_string(line_number) + ": expected " + std::to_string(width) + " bits, found " + std::to_string(bits.size()) + ".";
+      return std::nullopt;
+    }
+
+    if (new_instance)
+    {
+      stimuli.emplace_back(width);
+      new_instance = false;
+    }
+
+    auto& stimulus = stimuli.back();
+    stimulus.add_row();
+    for (std::size_t pin = 0; pin < width; pin++)
+    {
+      stimulus.set(stimulus.steps() - 1, pin, bits[pin] == '1');
+    }
+  }
+
+  return stimuli;
+}
+
+/**
+ * Write waveforms in the layout read_stimuli reads, one block of rows per instance.
+ */
+inline auto write_waveforms(const std::string& path, const std::vector<Waveform>& waveforms) -> bool
+{
+  std::ofstream file(path);
+
+  if (!file.is_open())
+  {
+    return false;
+  }
+
+  for (std::size_t index = 0; index < waveforms.size(); index++)
+  {
+    const auto& waveform = waveforms[index];
+    if (index != 0) file << '\n';
+    file << "// instance " << index << '\n';
+
+    std::string bits(waveform.width(), '0');
+    for (std::size_t step = 0; step < waveform.steps(); step++)
+    {
+      for (std::size_t pin = 0; pin < waveform.width(); pin++)
+      {
+        bits[pin] = waveform.get(step, pin) ? '1' : '0';
+      }
+      file << bits << '\n';
+    }
+  }
+
+  return static_cast<bool>(file);
+}
+
+} /* namespace batch */
+
+#endif /* BATCH_H */
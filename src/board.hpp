@@ -26,6 +26,7 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <filesystem>
 #include <memory>
 #include <map>
 
@@ -33,6 +34,7 @@
 #include "lang/core/trie.hpp"
 #include "lang/hdl/parser.hpp"
 #include "gate.hpp"
+#include "table_cache.hpp"
 #include "utils.hpp"
 #include "builtin/builtin.hpp"
 
@@ -69,8 +71,9 @@ public:
       gate_ptr->serialize();      
     }
 
-    components[gate_ptr->name] = std::move(builtin_gate);
-    search_trie.insert(gate_ptr->name);
+    const auto name = gate_ptr->get_name();
+    components[name] = std::move(builtin_gate);
+    search_trie.insert(name);
   }
 
   ~Board()
@@ -136,7 +139,9 @@ public:
 
   void save_sketch(std::unique_ptr<Gate> sketch)
   {
-    std::string name = sketch->name;
+    sketch->flatten(optimize_netlists);
+    substitute_primitive(*sketch);
+    std::string name = sketch->get_name();
     components.insert({name, std::move(sketch)});
   }
 
@@ -165,6 +170,43 @@ public:
     return res;
   }
 
+  /**
+   * Copies of a finished chip computing the same as a word-level primitive
+   * (and_16, add_16, ...) are made as that primitive instead. The chip itself
+   * keeps its parts, it stays the reference.
+   */
+  void substitute_primitive(Gate& chip)
+  {
+    if (!word_primitives) return;
+
+    if (const auto* entry = builtin::match(chip))
+    {
+      chip.builtin_entry = entry;
+    }
+  }
+
+  /**
+   * Serialize a chip loaded from gate_path, going through the table cache
+   * stored next to it (see table_cache.hpp).
+   */
+  void precompute(Gate* chip, const std::string& gate_path)
+  {
+    const auto cache_path = std::filesystem::path(gate_path).replace_extension(TABLE_EXTENSION).string();
+    const auto key = chip->content_hash();
+    const auto input_count = chip->input_pins.size();
+
+    if (auto table = table_cache::load(cache_path, key, input_count, chip->output_pins.size()))
+    {
+      chip->set_truth_table(std::move(*table));
+      return;
+    }
+
+    if (chip->serialize())
+    {
+      table_cache::store(cache_path, key, input_count, *chip->serialized_computation_ptr);
+    }
+  }
+
   bool load_file(const std::string& file_path)
   {
     AssemTokenTypeScanner scanner{};
@@ -259,7 +301,7 @@ public:
   					return false;
   				}
 
-          current->serialize();
+          precompute(current, file_path);
         }
         break; case AssemTokenType::Create: 
   			{
@@ -372,7 +414,19 @@ public:
   			}
         break; case AssemTokenType::Save: 
   			{
-  				// Simply get out of context.
+  				// The chip is complete, compile it for simulation and get out of context.
+  				if (auto current = board->context().second; current != nullptr)
+  				{
+  					current->flatten(board->optimize_netlists);
+
+  					// Small combinational chips collapse into a single table lookup.
+  					if (current->is_precomputable(board->precompute_input_limit))
+  					{
+  						precompute(current, file_path);
+  					}
+
+  					substitute_primitive(*current);
+  				}
   				board->reset_context();
   			}
       }
@@ -381,6 +435,24 @@ public:
   	return true;
   }
 
+  /**
+   * Chips loaded from now on with at most this many inputs are precomputed
+   * automatically if they are purely combinational.
+   */
+  std::size_t precompute_input_limit{ AUTO_PRECOMPUTE_INPUT_LIMIT };
+
+  /**
+   * Whether chips loaded from now on are simulated on an optimized netlist
+   * (see netlist::Optimizer).
+   */
+  bool optimize_netlists{ true };
+
+  /**
+   * Whether chips loaded from now on may be replaced by a word-level primitive
+   * in the chips using them (see substitute_primitive).
+   */
+  bool word_primitives{ true };
+
 private:
   Trie                                         search_trie;
   static Board*                                singleton;
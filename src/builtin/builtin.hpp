@@ -31,8 +31,95 @@
  */
 #include "ram16k.hpp"
 #include "pc.hpp"
-#include "mux16.hpp"
 #include "register.hpp"
 #include "rom32k.hpp"
+#include "word.hpp"
+#include "registry.hpp"
+#include "../netlist/aig.hpp"
+
+namespace builtin
+{
+
+/**
+ * Every built-in, in any order. Adding one only takes its header, its GateType
+ * and a line here.
+ */
+inline constexpr Entry entries[] = {
+  {
+    GateType::NAND, "nand", nullptr,
+    [](Gate& gate) { gate.output_pins[0].set(!(gate.input_pins[0].is_active() && gate.input_pins[1].is_active())); },
+    nullptr, nullptr,
+    WordOp::NONE,
+  },
+  {
+    // Latches on the clock pin when simulated, a clock edge (see Gate::tick)
+    // doesn't look at it. Its input is still the one it would have sampled.
+    GateType::DFF, "dff", nullptr,
+    [](Gate& gate) { if (gate.input_pins[1].is_active()) gate.output_pins[0].set_state(gate.input_pins[0].get_state()); },
+    nullptr,
+    [](Gate& gate) { gate.output_pins[0].set_state(gate.input_pins[0].get_state()); },
+    WordOp::NONE,
+  },
+  entry_of<PC>(),
+  entry_of<Ram16k>(),
+  entry_of<Rom32k>(),
+  entry_of<Register>(),
+  entry_of<And16>(),
+  entry_of<Or16>(),
+  entry_of<Xor16>(),
+  entry_of<Not16>(),
+  entry_of<Add16>(),
+  entry_of<Inc16>(),
+  entry_of<Mux16>(),
+  entry_of<Or16Way>(),
+};
+
+/**
+ * The word-level primitive computing the same function as a finished chip, if
+ * any, which can then stand in for it (see Gate::builtin_entry). Only pure
+ * combinational chips are considered, and only on a proof that they agree on
+ * every input (see netlist::prove_equivalence); a chip which can't be proven
+ * equivalent keeps being simulated as written.
+ */
+inline auto match(const Gate& chip) -> const Entry*
+{
+  if (chip.type != GateType::CUSTOM || !chip.is_combinational())
+  {
+    return nullptr;
+  }
+
+  std::shared_ptr<const netlist::Aig> graph{};
+
+  for (const auto& entry : entries)
+  {
+    if (entry.word == WordOp::NONE
+    || word_inputs(entry.word) != chip.input_pins.size()
+    || word_outputs(entry.word) != chip.output_pins.size())
+    {
+      continue;
+    }
+
+    if (graph == nullptr)
+    {
+      graph = chip.serialized ? netlist::build_aig(*chip.serialized_computation_ptr)
+            : (chip.design->flat_aig != nullptr) ? chip.design->flat_aig
+            : netlist::build_aig(*chip.design->flat_netlist);
+
+      if (graph == nullptr) return nullptr;
+    }
+
+    std::vector<std::size_t> order(word_inputs(entry.word));
+    word_order(entry.word, order.data());
+
+    if (netlist::prove_equivalence(*graph, *netlist::build_aig(entry.word), order) == netlist::Proof::EQUIVALENT)
+    {
+      return &entry;
+    }
+  }
+
+  return nullptr;
+}
+
+} /* namespace builtin */
 
 #endif
@@ -26,19 +26,22 @@
 
 struct PC : Gate 
 {
+  static constexpr GateType    builtin_type { GateType::PC };
+  static constexpr const char* builtin_name { "pc" };
+
   explicit PC()
     : Gate(
         20,             // 16-bit input, load, inc, reset, clock
         16,             // 16-bit output 
-        GateType::PC,   // Gate type
-        "pc"            // Gate name
+        builtin_type,   // Gate type
+        builtin_name    // Gate name
       ),
       register_value(0)
   {
   }
 
 
-  auto handle_pc_impl()  -> void
+  auto evaluate_impl()  -> void
   {
     if (!clock_pin().is_active()) action_taken = false;
 
@@ -67,12 +70,30 @@ struct PC : Gate
 
     // We don't want to continuously forward. 
     // Only forward once, when the signal turned from inactive to active.
-    previous_state = pinvec_to_uint(this->input_pins, 16, 20);
+    previous_state = read_input_bus<16, 4>();
+  }
+
+  /**
+   * Clock edge in two phases (see Gate::tick), with the same priority as
+   * evaluate_impl. The clock pin isn't looked at.
+   */
+  auto sample_impl() -> void
+  {
+    if (reset_pin().is_active()) next_value = 0;
+    else if (inc_pin().is_active()) next_value = this->register_value + 1;
+    else if (load_pin().is_active()) next_value = read_input_bus<0, 16>();
+    else next_value = this->register_value;
+  }
+
+  auto commit_impl() -> void
+  {
+    this->register_value = next_value;
+    sync_output();
   }
 
   auto sync_output() -> void
   {
-    set_pinvec(this->register_value, this->output_pins, 0, 16);
+    write_output_bus<0, 16>(this->register_value);
   }
 
   auto increment() -> void
@@ -82,7 +103,7 @@ struct PC : Gate
 
   auto load() -> void
   {
-    this->register_value = pinvec_to_uint<uint16_t>(input_pins, 0, 16);
+    this->register_value = read_input_bus<0, 16>();
   }
 
   auto reset() -> void
@@ -92,7 +113,7 @@ struct PC : Gate
 
   auto forwardable() -> bool
   {
-    const auto current_state = pinvec_to_uint(this->input_pins, 16, 20);
+    const auto current_state = read_input_bus<16, 4>();
     return previous_state != current_state 
         && clock_pin().is_active();
   }
@@ -122,6 +143,7 @@ struct PC : Gate
    * 
    */
   uint16_t register_value { 0 };
+  uint16_t next_value { 0 };
   PinState previous_clock_state { PinState::INACTIVE };
   bool     action_taken { false };
   uint32_t previous_state { 0 };
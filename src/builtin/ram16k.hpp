@@ -26,24 +26,27 @@
 
 struct Ram16k : Gate 
 {
+  static constexpr GateType    builtin_type { GateType::RAM_16K };
+  static constexpr const char* builtin_name { "ram_16k" };
+
   explicit Ram16k()
     : Gate(
         32,                 // 16-bit input, 14-bit address, load, clock
         16,                 // 16-bit output 
-        GateType::RAM_16K,  // Gate type
-        "ram_16k"           // Gate name
+        builtin_type,       // Gate type
+        builtin_name        // Gate name
       )
   {
   }
 
   auto read_in() -> uint16_t
   {
-    return pinvec_to_uint<uint16_t>(this->input_pins, 0, 16);
+    return read_input_bus<0, 16>();
   }
 
   auto read_address() -> std::size_t
   {
-    return pinvec_to_uint<uint16_t>(this->input_pins, 16, 30);
+    return read_input_bus<16, 14>();
   }
 
   auto load_pin() -> Pin&
@@ -59,7 +62,7 @@ struct Ram16k : Gate
   auto sync_output() -> void
   {
     const auto value = data[address];
-    set_pinvec(value, this->output_pins, 0, 16);
+    write_output_bus<0, 16>(value);
   }
 
   auto load_value() -> void
@@ -69,7 +72,7 @@ struct Ram16k : Gate
     // std::cout << "LOAD[" << address << "] " << value << '\n';
   }
 
-  auto handle_ram_16k_impl() -> void
+  auto evaluate_impl() -> void
   {
     // std::cout << "Clock[" << clock_pin().is_active() << "], Load[" << load_pin().is_active() << "]\n";
     // Set the new address
@@ -89,11 +92,34 @@ struct Ram16k : Gate
     sync_output();
   }
 
+  /**
+   * Clock edge in two phases (see Gate::tick), one write per call so no need
+   * for `immutable`. The clock pin isn't looked at.
+   */
+  auto sample_impl() -> void
+  {
+    address = read_address();
+    pending_write = load_pin().is_active();
+    pending_value = read_in();
+  }
+
+  auto commit_impl() -> void
+  {
+    if (pending_write)
+    {
+      data[address] = pending_value;
+    }
+
+    sync_output();
+  }
+
   /*
    * Members.
    */
     std::size_t address     {0};
     uint16_t    data[16384] {0};
     bool immutable { false };
+    bool        pending_write {false};
+    uint16_t    pending_value {0};
 };
 
@@ -26,12 +26,15 @@
 
 struct Register : Gate
 {
+  static constexpr GateType    builtin_type { GateType::REGISTER };
+  static constexpr const char* builtin_name { "register" };
+
   explicit Register()
     : Gate(
         18,                 // 16-bit input, load, clock
         16,                 // 16-bit output 
-        GateType::REGISTER, // Gate type
-        "register"          // Gate name
+        builtin_type,       // Gate type
+        builtin_name        // Gate name
       )
   {
   }
@@ -48,13 +51,13 @@ struct Register : Gate
 
   auto load_value() -> uint16_t 
   {
-    return pinvec_to_uint(this->input_pins, 0, 16);
+    return read_input_bus<0, 16>();
   }
 
   // There is a big problem with this.
   // We don't know which signal arrives first,
   // and we don't know which signal might be out-dated.
-  auto handle_register_impl() -> void
+  auto evaluate_impl() -> void
   {
     const uint16_t loaded_value = load_value();
 
@@ -76,7 +79,7 @@ struct Register : Gate
         this->data = loaded_value;
         // std::cout << "Setting value: " << this->data << '\n';
 
-        set_pinvec(loaded_value, this->output_pins, 0, 16);
+        write_output_bus<0, 16>(loaded_value);
 
         // std::cout << "\n [ WRITTEN ]\n";
 
@@ -97,9 +100,19 @@ struct Register : Gate
     previous_clock_state = clock_pin().get_state();
   }
 
-  auto commit() -> bool
+  /**
+   * Clock edge in two phases (see Gate::tick), no need to guess which signal came
+   * first: every input has settled before the edge. The clock pin isn't looked at.
+   */
+  auto sample_impl() -> void
+  {
+    next_data = load_pin().is_active() ? load_value() : this->data;
+  }
+
+  auto commit_impl() -> void
   {
-    return previous_clock_state == PinState::ACTIVE && !clock_pin().is_active();
+    this->data = next_data;
+    write_output_bus<0, 16>(this->data);
   }
 
   /**
@@ -108,6 +121,7 @@ struct Register : Gate
   PinState previous_clock_state { PinState::INACTIVE };
   PinState previous_load_state  { PinState::INACTIVE };
   uint8_t  written              { 0 };
-  uint16_t data;
+  uint16_t data                 { 0 };
+  uint16_t next_data            { 0 };
 };
 
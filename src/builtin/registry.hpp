@@ -0,0 +1,96 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef BUILTIN_REGISTRY_H
+#define BUILTIN_REGISTRY_H
+
+#include <memory>
+
+#include "../gate.hpp"
+#include "word.hpp"
+
+namespace builtin
+{
+
+/**
+ * Everything the simulator needs to know about one type of built-in, looked up
+ * by gate type (see find). Combinational built-ins have no sample/commit,
+ * sequential ones may leave sample out when commit can read the inputs itself.
+ * Built-ins which are plain gates (nand, dff) are made by the board and have no create.
+ */
+struct Entry
+{
+  GateType                 type;
+  const char*              name;
+  std::unique_ptr<Gate>  (*create)();
+  void                   (*evaluate)(Gate&);
+  void                   (*sample)(Gate&);
+  void                   (*commit)(Gate&);
+  WordOp                   word;      // NONE unless it is a word-level primitive.
+};
+
+/**
+ * Primitive a built-in gate computes, NONE for anything else.
+ */
+inline auto word_op(const Gate& gate) -> WordOp
+{
+  return (gate.type != GateType::CUSTOM && gate.builtin_entry != nullptr) ? gate.builtin_entry->word : WordOp::NONE;
+}
+
+/**
+ * Entry of a built-in struct, which declares its builtin_type and builtin_name
+ * (and builtin_word for primitives) and implements evaluate_impl (plus
+ * sample_impl and commit_impl when clocked).
+ */
+template <typename T>
+constexpr auto entry_of() -> Entry
+{
+  Entry entry{
+    T::builtin_type,
+    T::builtin_name,
+    []() -> std::unique_ptr<Gate> { return std::make_unique<T>(); },
+    [](Gate& gate) { static_cast<T&>(gate).evaluate_impl(); },
+    nullptr,
+    nullptr,
+    WordOp::NONE,
+  };
+
+  if constexpr (requires { T::builtin_word; })
+  {
+    entry.word = T::builtin_word;
+  }
+
+  if constexpr (requires(T& gate) { gate.sample_impl(); gate.commit_impl(); })
+  {
+    entry.sample = [](Gate& gate) { static_cast<T&>(gate).sample_impl(); };
+    entry.commit = [](Gate& gate) { static_cast<T&>(gate).commit_impl(); };
+  }
+
+  return entry;
+}
+
+} /* namespace builtin */
+
+#endif /* BUILTIN_REGISTRY_H */
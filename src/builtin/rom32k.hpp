@@ -26,31 +26,34 @@
 
 struct Rom32k : Gate 
 {
+  static constexpr GateType    builtin_type { GateType::ROM_32K };
+  static constexpr const char* builtin_name { "rom_32k" };
+
   // NOTE: The input is supposed to be only one 15-bit input bus for address,
   // but here we have extra for testing purposes.
   explicit Rom32k()
     : Gate(
         48,                 // 16-bit input, 15-bit address (read), 15-bit address (write), load, clock
         16,                 // 16-bit output 
-        GateType::ROM_32K,  // Gate type
-        "rom_32k"           // Gate name
+        builtin_type,       // Gate type
+        builtin_name        // Gate name
       )
   {
   }
 
   auto read_in() -> uint16_t
   {
-    return pinvec_to_uint<uint16_t>(this->input_pins, 0, 16);
+    return read_input_bus<0, 16>();
   }
 
   auto read_address() -> std::size_t
   {
-    return pinvec_to_uint<uint16_t>(this->input_pins, 16, 31);
+    return read_input_bus<16, 15>();
   }
 
   auto write_address() -> std::size_t
   {
-    return pinvec_to_uint<uint16_t>(this->input_pins, 31, 46);
+    return read_input_bus<31, 15>();
   }
 
   auto load_pin() -> Pin&
@@ -66,7 +69,7 @@ struct Rom32k : Gate
   auto sync_output() -> void
   {
     const auto value = data[address];
-    set_pinvec(value, this->output_pins, 0, 16);
+    write_output_bus<0, 16>(value);
   }
 
   auto load_value() -> void
@@ -76,7 +79,7 @@ struct Rom32k : Gate
     data[address] = value;
   }
 
-  auto handle_rom_32k_impl() -> void
+  auto evaluate_impl() -> void
   {
     // Set the new address
     address = read_address();
@@ -91,11 +94,35 @@ struct Rom32k : Gate
     sync_output();
   }
 
+  /**
+   * Clock edge in two phases (see Gate::tick). The clock pin isn't looked at.
+   */
+  auto sample_impl() -> void
+  {
+    address = read_address();
+    pending_write = load_pin().is_active();
+    pending_address = write_address();
+    pending_value = read_in();
+  }
+
+  auto commit_impl() -> void
+  {
+    if (pending_write)
+    {
+      data[pending_address] = pending_value;
+    }
+
+    sync_output();
+  }
+
   /*
    * Members.
    */
     std::size_t address     {0};
     uint16_t    data[32768] {0};
+    bool        pending_write   {false};
+    std::size_t pending_address {0};
+    uint16_t    pending_value   {0};
 };
 
 
@@ -0,0 +1,237 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef BUILTIN_WORD_H
+#define BUILTIN_WORD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../gate.hpp"
+
+namespace builtin
+{
+
+/**
+ * Word-level primitives, standing in for the bit-sliced 16-bit chips built out of
+ * them (see match). Buses are 16 pins wide, the first pin being the most
+ * significant bit (so a[0] of the HDL is the last pin of a):
+ *
+ *   AND, OR, XOR, ADD   a[16] b[16]      -> out[16]
+ *   NOT, INC            in[16]           -> out[16]
+ *   MUX                 a[16] b[16] sel  -> out[16]   (sel ? b : a)
+ *   OR_REDUCE           in[16]           -> out
+ */
+enum class WordOp : std::uint8_t
+{
+  NONE,
+  AND,
+  OR,
+  XOR,
+  NOT,
+  ADD,
+  INC,
+  MUX,
+  OR_REDUCE,
+};
+
+constexpr std::size_t WORD_WIDTH{ 16 };
+constexpr std::size_t WORD_MAX_INPUTS{ 2 * WORD_WIDTH + 1 };
+constexpr std::size_t WORD_MAX_OUTPUTS{ WORD_WIDTH };
+
+constexpr auto word_inputs(WordOp op) -> std::size_t
+{
+  switch (op)
+  {
+    case WordOp::NOT:
+    case WordOp::INC:
+    case WordOp::OR_REDUCE: return WORD_WIDTH;
+    case WordOp::MUX: return 2 * WORD_WIDTH + 1;
+    case WordOp::NONE: return 0;
+    default: return 2 * WORD_WIDTH;
+  }
+}
+
+constexpr auto word_outputs(WordOp op) -> std::size_t
+{
+  switch (op)
+  {
+    case WordOp::OR_REDUCE: return 1;
+    case WordOp::NONE: return 0;
+    default: return WORD_WIDTH;
+  }
+}
+
+constexpr auto word_name(WordOp op) -> const char*
+{
+  switch (op)
+  {
+    case WordOp::AND: return "and_16";
+    case WordOp::OR: return "or_16";
+    case WordOp::XOR: return "xor_16";
+    case WordOp::NOT: return "not_16";
+    case WordOp::ADD: return "add_16";
+    case WordOp::INC: return "inc_16";
+    case WordOp::MUX: return "mux_16";
+    case WordOp::OR_REDUCE: return "or_16_way";
+    case WordOp::NONE: return "";
+  }
+  return "";
+}
+
+/**
+ * Outputs of a primitive for one row of inputs, both laid out like the rows of a
+ * TruthTable (first pin in the most significant bit).
+ */
+constexpr auto word_evaluate(WordOp op, std::uint64_t row) -> std::uint64_t
+{
+  constexpr std::uint64_t mask{ (std::uint64_t{ 1 } << WORD_WIDTH) - 1 };
+
+  const auto a = (row >> WORD_WIDTH) & mask;
+  const auto b = row & mask;
+
+  switch (op)
+  {
+    case WordOp::AND: return a & b;
+    case WordOp::OR: return a | b;
+    case WordOp::XOR: return a ^ b;
+    case WordOp::NOT: return ~b & mask;
+    case WordOp::ADD: return (a + b) & mask;
+    case WordOp::INC: return (b + 1) & mask;
+    case WordOp::MUX: return ((row & 1) ? (row >> 1) : (row >> (WORD_WIDTH + 1))) & mask;
+    case WordOp::OR_REDUCE: return b != 0;
+    case WordOp::NONE: return 0;
+  }
+  return 0;
+}
+
+/**
+ * The same primitive one bit at a time, for simulators which work on bits (the
+ * and-inverter graph, the lanes of the bit parallel simulator, native code).
+ * Logic provides land, lor, lxor, lnot, mux(sel, a, b) (sel ? b : a) and
+ * constant(bool) over its type of bit.
+ */
+template <typename Bit, typename Logic>
+auto word_lower(WordOp op, const Bit* in, Bit* out, Logic& logic) -> void
+{
+  constexpr auto W = WORD_WIDTH;
+
+  switch (op)
+  {
+    break; case WordOp::AND: for (std::size_t k = 0; k < W; k++) out[k] = logic.land(in[k], in[W + k]);
+    break; case WordOp::OR: for (std::size_t k = 0; k < W; k++) out[k] = logic.lor(in[k], in[W + k]);
+    break; case WordOp::XOR: for (std::size_t k = 0; k < W; k++) out[k] = logic.lxor(in[k], in[W + k]);
+    break; case WordOp::NOT: for (std::size_t k = 0; k < W; k++) out[k] = logic.lnot(in[k]);
+    break; case WordOp::MUX: for (std::size_t k = 0; k < W; k++) out[k] = logic.mux(in[2 * W], in[k], in[W + k]);
+    break; case WordOp::ADD:
+    {
+      // Ripple carry, from the last (least significant) pin up.
+      Bit carry = logic.constant(false);
+      for (std::size_t k = W; k-- > 0;)
+      {
+        const Bit half = logic.lxor(in[k], in[W + k]);
+        out[k] = logic.lxor(half, carry);
+        if (k > 0) carry = logic.lor(logic.land(in[k], in[W + k]), logic.land(carry, half));
+      }
+    }
+    break; case WordOp::INC:
+    {
+      Bit carry = logic.constant(true);
+      for (std::size_t k = W; k-- > 0;)
+      {
+        out[k] = logic.lxor(in[k], carry);
+        if (k > 0) carry = logic.land(in[k], carry);
+      }
+    }
+    break; case WordOp::OR_REDUCE:
+    {
+      Bit any = in[0];
+      for (std::size_t k = 1; k < W; k++) any = logic.lor(any, in[k]);
+      out[0] = any;
+    }
+    break; case WordOp::NONE: break;
+  }
+}
+
+/**
+ * Input pins of a primitive in the order its decision diagrams stay small in
+ * (see netlist::prove_equivalence): the select first, then the bits of both
+ * operands side by side, least significant first, the way the carry goes.
+ * Fills in word_inputs(op) entries of order.
+ */
+constexpr auto word_order(WordOp op, std::size_t* order) -> void
+{
+  constexpr auto W = WORD_WIDTH;
+  std::size_t n = 0;
+
+  if (op == WordOp::MUX) order[n++] = 2 * W;
+
+  for (std::size_t k = W; k-- > 0;)
+  {
+    order[n++] = k;
+    if (word_inputs(op) > W) order[n++] = W + k;
+  }
+}
+
+/**
+ * Built-in gate of a primitive.
+ */
+template <GateType Type, WordOp Op>
+struct WordGate : Gate
+{
+  static constexpr GateType    builtin_type { Type };
+  static constexpr const char* builtin_name { word_name(Op) };
+  static constexpr WordOp      builtin_word { Op };
+
+  explicit WordGate()
+    : Gate(
+        word_inputs(Op),    // Input pins, see WordOp
+        word_outputs(Op),   // Output pins
+        builtin_type,       // Gate type
+        builtin_name        // Gate name
+      )
+  {
+  }
+
+  auto evaluate_impl() -> void
+  {
+    constexpr auto inputs = word_inputs(Op);
+    constexpr auto outputs = word_outputs(Op);
+    write_output_bus<0, outputs>(word_evaluate(Op, read_input_bus<0, inputs>()));
+  }
+};
+
+} /* namespace builtin */
+
+using And16    = builtin::WordGate<GateType::AND_16,    builtin::WordOp::AND>;
+using Or16     = builtin::WordGate<GateType::OR_16,     builtin::WordOp::OR>;
+using Xor16    = builtin::WordGate<GateType::XOR_16,    builtin::WordOp::XOR>;
+using Not16    = builtin::WordGate<GateType::NOT_16,    builtin::WordOp::NOT>;
+using Add16    = builtin::WordGate<GateType::ADD_16,    builtin::WordOp::ADD>;
+using Inc16    = builtin::WordGate<GateType::INC_16,    builtin::WordOp::INC>;
+using Mux16    = builtin::WordGate<GateType::MUX_16,    builtin::WordOp::MUX>;
+using Or16Way  = builtin::WordGate<GateType::OR_16_WAY, builtin::WordOp::OR_REDUCE>;
+
+#endif /* BUILTIN_WORD_H */
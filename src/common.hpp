@@ -37,6 +37,9 @@ constexpr const char* GATE_EXTENSION{ ".gate" };
 constexpr const char* META_EXTENSION{ ".meta" };
 constexpr const char* HDL_EXTENSION{ ".hdl" };
 constexpr const char* TEST_EXTENSION{ ".tst" };
+constexpr const char* TABLE_EXTENSION{ ".table" };
+constexpr const char* STIMULUS_EXTENSION{ ".stim" };
+constexpr const char* WAVEFORM_EXTENSION{ ".wave" };
 constexpr const std::size_t TOOLBOX_WIDTH = 150;
 constexpr const std::size_t TOOLBOX_X_MARGIN = 7.f;
 constexpr const std::size_t TOOLBOX_TOP_MARGIN = 20.f;
@@ -57,6 +60,12 @@ inline auto hdl_file(const std::string& name) -> std::string
  */
 constexpr std::size_t INPUT_PIN_LIMIT{ 1000 };
 
+/**
+ * Combinational chips with at most this many inputs are precomputed when they are
+ * loaded, even without a `precompute` in their recipe. Zero turns this off.
+ */
+constexpr std::size_t AUTO_PRECOMPUTE_INPUT_LIMIT{ 12 };
+
 /**
  * GUI wire's signal speed.
  */
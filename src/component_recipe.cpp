@@ -30,12 +30,15 @@ ComponentRecipe ComponentRecipe::construct_recipe(const Gate* gate)
   ComponentRecipe recipe{};
 
   // Set the recipe component name.
-  recipe.set_component_name(gate->name);
+  recipe.set_component_name(gate->get_name());
 
   // Add sub components and mark dependency.
-  for (const auto& sub_component : gate->subgates)
+  if (gate->design != nullptr)
   {
-    recipe.add_sub_component(sub_component->name);
+    for (const auto& sub_component : gate->design->subgates)
+    {
+      recipe.add_sub_component(sub_component->get_name());
+    }
   }
 
   // Add i/o pins.
@@ -22,27 +22,185 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
 #include "gate.hpp"
 #include "board.hpp"
 #include "wire.hpp"
+#include "netlist/aig.hpp"
+#include "netlist/bit_parallel.hpp"
+#include "netlist/bytecode.hpp"
+#include "netlist/compiler.hpp"
+#include "netlist/event.hpp"
+#include "netlist/native.hpp"
+#include "netlist/optimizer.hpp"
+#include "table_cache.hpp"
 
 /**
  * Builtin Gates
  */
 #include "builtin/builtin.hpp"
 
+Gate::Gate(std::size_t ipc, std::size_t opc, GateType gate_type, const std::string& gate_name, bool is_serialized)
+  : type{ gate_type }
+  , builtin_entry{ builtin::find(gate_type, gate_name) }
+  , serialized{ is_serialized }
+  , input_pins(ipc, Pin(this))
+  , output_pins(opc, Pin())
+{
+  // A built-in going by the name of its entry has nothing else to hold.
+  if (type == GateType::CUSTOM || builtin_entry == nullptr || gate_name != builtin_entry->name)
+  {
+    design = std::make_unique<ChipDesign>();
+    design->name = gate_name;
+  }
+
+  bind_pins();
+}
+
+Gate::Gate(std::shared_ptr<const ChipProfile> chip_profile)
+  : type{ chip_profile->type }
+  , builtin_entry{ builtin::find(chip_profile->type) }
+  , serialized{ chip_profile->truth_table != nullptr }
+  , serialized_computation_ptr{ chip_profile->truth_table }
+  , profile{ std::move(chip_profile) }
+  , input_pins(profile->input_count, Pin(this))
+  , output_pins(profile->output_count, Pin())
+{
+  bind_pins();
+
+  if (!serialized && profile->netlist != nullptr)
+  {
+    start_netlist(profile->program);
+
+    if (profile->event_driven)
+    {
+      set_event_driven(true);
+    }
+
+    if (profile->native != nullptr)
+    {
+      native_simulator = std::make_unique<netlist::NativeSimulator>(profile->native);
+      flat_interpreter.reset();
+      flat_events.reset();
+    }
+  }
+}
+
+Gate::~Gate() = default;
+
+auto Gate::get_profile() -> std::shared_ptr<const ChipProfile>
+{
+  if (profile == nullptr && (serialized || flattened))
+  {
+    const auto& compiled = chip_design();
+
+    profile = std::make_shared<const ChipProfile>(ChipProfile{
+      type,
+      compiled.name,
+      input_pins.size(),
+      output_pins.size(),
+      serialized ? serialized_computation_ptr : nullptr,
+      flattened ? compiled.flat_netlist : nullptr,
+      flattened ? compiled.flat_aig : nullptr,
+      flattened ? compiled.flat_program : nullptr,
+      flattened ? compiled.native_chip : nullptr,
+      flat_events != nullptr,
+      content_hash(),
+    });
+  }
+
+  return profile;
+}
+
+void Gate::release_profile()
+{
+  // The chip changed, the next duplication builds a fresh profile.
+  if (profile != nullptr)
+  {
+    // An instance only had its name in there.
+    chip_design();
+    profile.reset();
+  }
+}
+
+auto Gate::chip_design() -> ChipDesign&
+{
+  if (design == nullptr)
+  {
+    auto made = std::make_unique<ChipDesign>();
+    made->name = get_name();
+    design = std::move(made);
+  }
+
+  return *design;
+}
+
 std::size_t Gate::add_subgate(std::string_view gate_name, Board* board)
 {
   auto board_instance = (board == nullptr) ? Board::instance() : board;
-  auto key = subgate_count++;
+  auto& parts = chip_design();
+  auto key = parts.subgate_count++;
 	auto gate = board_instance->get_component(gate_name);
-  subgates.push_back(gate->duplicate(board));
+  parts.subgates.push_back(gate->duplicate(board));
+
+  const auto& subgate = *parts.subgates.back();
+  for (std::uint32_t i = 0; i < subgate.input_pins.size(); i++)
+  {
+    parts.subgate_inputs.push_back({ static_cast<std::uint32_t>(key), i });
+  }
+  for (std::uint32_t o = 0; o < subgate.output_pins.size(); o++)
+  {
+    parts.subgate_outputs.push_back({ static_cast<std::uint32_t>(key), o });
+  }
+
   return key;
 }
 
-void Gate::handle_custom_type(std::unordered_set<Gate*> was_visited)
+void Gate::handle_custom_type(std::unordered_set<Gate*>& was_visited)
 {
-  was_visited.insert(this);
+  // The set is shared with the caller, which has to find it as it left it: every
+  // gate added or removed here (and by the subgates, which clean up after
+  // themselves) is put back the way it was on the way out.
+  std::unordered_map<Gate*, bool> was_in{};
+
+  const auto visit = [&](Gate* gate) {
+    if (was_visited.insert(gate).second) was_in.try_emplace(gate, false);
+  };
+
+  const auto unvisit = [&](Gate* gate) {
+    if (was_visited.erase(gate) != 0) was_in.try_emplace(gate, true);
+  };
+
+  struct Restore
+  {
+    std::unordered_set<Gate*>&       set;
+    std::unordered_map<Gate*, bool>& was_in;
+
+    ~Restore()
+    {
+      for (const auto& [gate, in] : was_in)
+      {
+        if (in) set.insert(gate);
+        else set.erase(gate);
+      }
+    }
+  } restore{ was_visited, was_in };
+
+  visit(this);
+
+  // Same inputs, same outputs.
+  if (is_combinational())
+  {
+    const auto words = plane_words(input_pins.size());
+    auto* settled = input_plane.data() + words;
+
+    if (inputs_settled && std::equal(input_plane.data(), settled, settled)) return;
+    std::copy_n(input_plane.data(), words, settled);
+    inputs_settled = true;
+  }
 
   if (serialized)
   {
@@ -50,42 +208,79 @@ void Gate::handle_custom_type(std::unordered_set<Gate*> was_visited)
     return;
   }
 
-  std::vector<Pin> to_explore{ input_pins };
+  if (native_simulator != nullptr)
+  {
+    simulate_native();
+    return;
+  }
+
+  if (flat_events != nullptr)
+  {
+    simulate_flattened();
+    return;
+  }
+
+  if (get_aig() != nullptr)
+  {
+    simulate_aig();
+    return;
+  }
+
+  if (flattened)
+  {
+    simulate_flattened();
+    return;
+  }
+
+  if (!design->wires_indexed)
+  {
+    index_wires();
+  }
+
+  std::vector<const Pin*> to_explore{};
+  std::vector<const Pin*> exploring{};
   std::vector<Gate*> gates{};
-  std::size_t n {0};
+
+  for (const auto& pin : input_pins)
+  {
+    to_explore.push_back(&pin);
+  }
 
   while( !to_explore.empty() )
   {
-    std::vector<Pin> exploring = std::move(to_explore);
-    int index {0};
+    std::swap(exploring, to_explore);
+    to_explore.clear();
+    std::size_t index {0};
 
     // Keep exploring until we reach a deadend or a parent component.
     while ( index < exploring.size() )
     {
       // Grab the pin we're interested in.
-      auto pin = exploring.at(index++);
+      const auto* pin = exploring[index++];
 
       // Add the pins it is connected to.
-      for (auto& conn : pin.connections)
+      for (const auto* span : { &pin->inner, &pin->outer })
+      for (const auto& wire : *span)
       {
+        const auto* conn = &wire;
         if (conn->output == nullptr) continue;
 
-        const PinState original_state = conn->output->state;          
+        const PinState original_state = conn->output->get_state();          
 
         conn->simulate();
 
-        const bool changed = conn->output->state != original_state;          
+        const bool changed = conn->output->get_state() != original_state;          
 
         if (changed 
         && conn->output->has_parent() 
         && was_visited.contains(conn->output->parent))
         {
-          was_visited.erase(conn->output->parent);
+          unvisit(conn->output->parent);
         }
 
         if (!conn->output->has_parent())
         {
-          exploring.push_back(*conn->output);
+          exploring.push_back(conn->output);
         }
         else if (!was_visited.contains(conn->output->parent))
         {
@@ -98,11 +293,11 @@ void Gate::handle_custom_type(std::unordered_set<Gate*> was_visited)
     {
       if (was_visited.count(gate) == 0)
       {
-        was_visited.insert(gate);
+        visit(gate);
         gate->simulate(was_visited);
-        for (auto& output_pins : gate->output_pins)
+        for (const auto& output_pin : gate->output_pins)
         {
-          to_explore.push_back(output_pins);
+          to_explore.push_back(&output_pin);
         }
       }
     }
@@ -110,83 +305,489 @@ void Gate::handle_custom_type(std::unordered_set<Gate*> was_visited)
   }
 }
 
-bool Gate::connect_pins(Pin* input, Pin* output)
+bool Gate::flatten(bool optimize)
 {
-  input->connections.push_back(std::make_shared<Wire>(input, output));
-  wires.push_back(input->connections.back().get());
+  std::shared_ptr<const netlist::Netlist> compiled = netlist::Compiler(*this).compile();
+
+  if (compiled == nullptr)
+  {
+    return false;
+  }
+
+  if (optimize)
+  {
+    compiled = netlist::optimize(*compiled);
+  }
+
+  auto aig = netlist::build_aig(*compiled);
+  attach_netlist(std::move(compiled), std::move(aig));
+  release_profile();
   return true;
 }
 
-void Gate::simulate(std::unordered_set<Gate*> was_visited) 
+void Gate::attach_netlist(std::shared_ptr<const netlist::Netlist> netlist, std::shared_ptr<const netlist::Aig> aig, std::shared_ptr<const netlist::Program> program)
 {
-  // Simulate self.
-  switch (type) 
+  if (aig == nullptr && program == nullptr)
   {
-    break; case GateType::NAND: handle_nand();
-    break; case GateType::DFF: handle_dff();
-    break; case GateType::PC: handle_pc();
-    break; case GateType::RAM_16K: handle_ram_16k();
-    break; case GateType::ROM_32K: handle_rom_32k();
-    break; case GateType::MUX_16: handle_mux_16();
-    break; case GateType::REGISTER: handle_register();
-    break; case GateType::CUSTOM: handle_custom_type(was_visited);
-    break; default: log("Invalid type...?\n");
+    program = std::make_shared<const netlist::Program>(netlist);
   }
+
+  auto& compiled = chip_design();
+  compiled.flat_program = (aig == nullptr) ? std::move(program) : nullptr;
+  compiled.flat_netlist = std::move(netlist);
+  compiled.flat_aig = std::move(aig);
+
+  // Generated from the previous netlist.
+  compiled.native_chip.reset();
+  native_simulator.reset();
+
+  start_netlist(compiled.flat_program);
 }
 
-void Gate::handle_pc()
+void Gate::start_netlist(const std::shared_ptr<const netlist::Program>& program)
 {
-  static_cast<PC*>(this)->handle_pc_impl();
+  flat_interpreter = (program != nullptr) ? std::make_unique<netlist::Interpreter>(program) : nullptr;
+  flattened = true;
+  inputs_settled = false;
+
+  if (flat_events != nullptr)
+  {
+    set_event_driven(true);
+  }
 }
 
-auto Gate::handle_register() -> void 
+void Gate::attach_native(std::shared_ptr<const netlist::NativeChip> chip)
 {
- static_cast<Register*>(this)->handle_register_impl(); 
+  native_simulator = std::make_unique<netlist::NativeSimulator>(chip);
+  chip_design().native_chip = std::move(chip);
+  flat_interpreter.reset();
+  flat_events.reset();
 }
 
-void Gate::handle_ram_16k()
+void Gate::set_event_driven(bool on)
 {
-  static_cast<Ram16k*>(this)->handle_ram_16k_impl();
+  const auto& program = (design != nullptr) ? design->flat_program : profile->program;
+  const auto& netlist = (design != nullptr) ? design->flat_netlist : profile->netlist;
+
+  if (on)
+  {
+    flat_events = std::make_unique<netlist::EventSimulator>(netlist);
+    native_simulator.reset();
+    if (design != nullptr) design->native_chip.reset();
+  }
+  else
+  {
+    flat_events.reset();
+    if (program != nullptr && flat_interpreter == nullptr)
+    {
+      flat_interpreter = std::make_unique<netlist::Interpreter>(program);
+    }
+  }
+
+  inputs_settled = false;
 }
 
-void Gate::handle_rom_32k()
+void Gate::simulate_flattened(std::size_t cycles)
 {
-  static_cast<Rom32k*>(this)->handle_rom_32k_impl();
+  const auto run = [&](auto& engine) {
+    for (std::size_t i = 0; i < input_pins.size(); i++)
+    {
+      engine.set_input(i, input_pins[i].is_active());
+    }
+
+    const bool settled = (cycles == 0) ? engine.settle() : engine.tick(cycles);
+    if (!settled) report_oscillation();
+
+    for (std::size_t i = 0; i < output_pins.size(); i++)
+    {
+      output_pins[i].set(engine.get_output(i));
+    }
+  };
+
+  if (flat_events != nullptr)
+  {
+    run(*flat_events);
+  }
+  else
+  {
+    run(*flat_interpreter);
+  }
 }
 
-auto Gate::handle_mux_16() -> void 
+void Gate::simulate_aig()
 {
-  static_cast<Mux16*>(this)->handle_mux_16_impl();
+  // Only the first lane is used. The graph keeps nothing between two calls, so the
+  // scratch space can be shared by every chip simulated on this thread.
+  thread_local std::vector<std::uint64_t> scratch{};
+
+  const auto& aig = *get_aig();
+  scratch.resize(aig.input_count + aig.node_count() + aig.outputs.size());
+
+  auto* inputs = scratch.data();
+  auto* nodes = inputs + aig.input_count;
+  auto* results = nodes + aig.node_count();
+
+  for (std::size_t i = 0; i < input_pins.size(); i++)
+  {
+    inputs[i] = input_pins[i].is_active();
+  }
+
+  aig.evaluate(inputs, nodes, results);
+
+  for (std::size_t i = 0; i < output_pins.size(); i++)
+  {
+    output_pins[i].set(results[i] & 1);
+  }
 }
 
-std::unique_ptr<Gate> Gate::duplicate(Board* board)
+void Gate::simulate_native(std::size_t cycles)
 {
-  // Really ugly but it must be done.
-  if (this->name == "pc") return std::make_unique<PC>();
-  else if (this->name == "ram_16k") return std::make_unique<Ram16k>();
-  else if (this->name == "rom_32k") return std::make_unique<Rom32k>();
-  else if (this->name == "mux_16") return std::make_unique<Mux16>();
-  else if (this->name == "register") return std::make_unique<Register>();
+  thread_local std::vector<std::uint8_t> in{};
+  thread_local std::vector<std::uint8_t> out{};
+  in.resize(input_pins.size());
+  out.resize(output_pins.size());
+
+  for (std::size_t i = 0; i < input_pins.size(); i++)
+  {
+    in[i] = input_pins[i].is_active();
+  }
 
-  auto g = std::make_unique<Gate>(input_pins.size(), output_pins.size(), this->type, this->name, this->serialized);
+  if (!native_simulator->step(in.data(), out.data(), cycles)) report_oscillation();
 
-  if (this->serialized)
+  for (std::size_t i = 0; i < output_pins.size(); i++)
   {
-    // If it is serialized we don't actually need to do any wiring (no simulation).
-    g->serialized_computation_ptr = this->serialized_computation_ptr;
-    return g;
+    output_pins[i].set(out[i] != 0);
+  }
+}
+
+void Gate::report_oscillation()
+{
+  if (oscillation_reported) return;
+  oscillation_reported = true;
+
+  log("Warning: component `", get_name(), "` does not settle, a feedback loop in it keeps oscillating.");
+}
+
+bool Gate::serialize(const SerializeOptions& options)
+{
+  // Build next to the current table, chips already pointing at it keep working
+  // until the new one is complete (or forever, if we get cancelled).
+  TruthTable table{};
+
+  // Reuse the flattened netlist if there is one, otherwise compile a throwaway one.
+  std::shared_ptr<const netlist::Netlist> compiled = flattened ? chip_design().flat_netlist : netlist::Compiler(*this).compile();
+  auto result = (compiled == nullptr) ? netlist::TabulateResult::UNSUPPORTED : netlist::tabulate(*compiled, table, options);
+
+  if (result == netlist::TabulateResult::UNSUPPORTED || result == netlist::TabulateResult::UNSETTLED)
+  {
+    // Stateful chips have to walk through every row in order, on this thread.
+    table = TruthTable(input_pins.size(), output_pins.size());
+    result = netlist::TabulateResult::DONE;
+
+    for (std::size_t i = 0; i < table.rows(); i++)
+    {
+      if (i % netlist::TABULATE_CHUNK_ROWS == 0 && i != 0)
+      {
+        if (options.cancelled())
+        {
+          result = netlist::TabulateResult::CANCELLED;
+          break;
+        }
+
+        if (options.progress) options.progress(i, table.rows());
+      }
+
+      write_input_bus(0, input_pins.size(), i);
+      simulate();
+      table.set(i, read_output_bus(0, output_pins.size()));
+    }
+
+    if (result == netlist::TabulateResult::DONE && options.progress)
+    {
+      options.progress(table.rows(), table.rows());
+    }
+  }
+
+  if (result == netlist::TabulateResult::CANCELLED)
+  {
+    return false;
+  }
+
+  set_truth_table(std::move(table));
+  return true;
+}
+
+auto Gate::set_truth_table(TruthTable table) -> void
+{
+  auto& compiled = chip_design();
+  compiled.serialized_computation = std::move(table);
+  this->serialized = true;
+  this->serialized_computation_ptr = &compiled.serialized_computation;
+  inputs_settled = false;
+  release_profile();
+}
+
+auto Gate::content_hash() const -> std::uint64_t
+{
+  if (profile != nullptr)
+  {
+    return profile->content_hash;
+  }
+
+  using namespace table_cache;
+
+  auto hash = hash_string(HASH_SEED, get_name());
+  hash = hash_value(hash, static_cast<std::uint64_t>(type));
+  hash = hash_value(hash, input_pins.size());
+  hash = hash_value(hash, output_pins.size());
+
+  if (design == nullptr)
+  {
+    return hash;
+  }
+
+  for (const auto& subgate : design->subgates)
+  {
+    hash = hash_value(hash, subgate->content_hash());
+  }
+
+  for (const auto& [src, dest] : design->wire_construction_recipe)
+  {
+    hash = hash_value(hash, src);
+    hash = hash_value(hash, dest);
+  }
+
+  return hash;
+}
+
+auto Gate::is_precomputable(std::size_t input_limit) const -> bool
+{
+  return flattened
+      && !serialized
+      && input_limit != 0
+      && input_pins.size() <= input_limit
+      && !get_netlist()->has_sequential()
+      && !get_netlist()->has_feedback()
+      && netlist::BitParallelSimulator::supports(*get_netlist());
+}
+
+auto Gate::is_combinational() const -> bool
+{
+  return serialized
+      || (flattened && !get_netlist()->has_sequential() && !get_netlist()->has_feedback());
+}
+
+bool Gate::connect_pins(Pin* input, Pin* output)
+{
+  auto& parts = chip_design();
+  parts.wires.emplace_back(input, output);
+  parts.wires_indexed = false;
+  return true;
+}
+
+void Gate::index_wires()
+{
+  auto& wires = design->wires;
+
+  for (auto& pin : input_pins) pin.inner = {};
+  for (auto& pin : output_pins) pin.inner = {};
+  for (auto& subgate : design->subgates)
+  {
+    for (auto& pin : subgate->input_pins) pin.outer = {};
+    for (auto& pin : subgate->output_pins) pin.outer = {};
+  }
+
+  // Group by source pin, wires leaving the same pin keep their recipe order.
+  std::stable_sort(wires.begin(), wires.end(), [](const Wire& a, const Wire& b) {
+    return std::less<const Pin*>{}(a.input, b.input);
+  });
+
+  for (std::size_t i = 0; i < wires.size();)
+  {
+    auto* source = wires[i].input;
+
+    auto j = i;
+    while (j < wires.size() && wires[j].input == source) j++;
+
+    auto& span = owns_pin(source) ? source->inner : source->outer;
+    span = { wires.data() + i, static_cast<std::uint32_t>(j - i) };
+    i = j;
+  }
+
+  design->wires_indexed = true;
+}
+
+void Gate::simulate()
+{
+  std::unordered_set<Gate*> was_visited{};
+  simulate(was_visited);
+}
+
+void Gate::simulate(std::unordered_set<Gate*>& was_visited) 
+{
+  // Simulate self.
+  if (type == GateType::CUSTOM)
+  {
+    handle_custom_type(was_visited);
+  }
+  else
+  {
+    builtin_entry->evaluate(*this);
+  }
+}
+
+void Gate::tick(std::size_t cycles)
+{
+  if (type != GateType::CUSTOM)
+  {
+    // A built-in on its own has no other cell to sample along with.
+    if (builtin_entry->commit == nullptr)
+    {
+      simulate();
+      return;
+    }
+
+    // Sequential ones are not evaluated in between, that would run the clock pin
+    // handling of EVAL (a register drops its load pin while the clock is low).
+    for (std::size_t cycle = 0; cycle < cycles; cycle++)
+    {
+      sample();
+      commit();
+    }
+    return;
+  }
+
+  if (!serialized && !flattened)
+  {
+    flatten();
+  }
+
+  if (native_simulator != nullptr)
+  {
+    simulate_native(cycles);
+  }
+  else if (flat_events != nullptr || flat_interpreter != nullptr)
+  {
+    simulate_flattened(cycles);
   }
   else
   {
-    // Not serialized, which means that we need to simulate it. 
-    // Add the subgates and copy the wiring.
-    for (std::size_t i = 0; i < subgate_count; i++)
+    // Precomputed or on a graph: combinational, nothing to clock.
+    simulate();
+  }
+}
+
+void Gate::sample()
+{
+  if (type != GateType::CUSTOM && builtin_entry->sample != nullptr)
+  {
+    builtin_entry->sample(*this);
+  }
+}
+
+void Gate::commit()
+{
+  if (type != GateType::CUSTOM && builtin_entry->commit != nullptr)
+  {
+    builtin_entry->commit(*this);
+  }
+}
+
+auto builtin::find(GateType type, std::string_view name) -> const Entry*
+{
+  // Indexed by type, built once from the list of entries.
+  static constexpr auto by_type = [] {
+    std::array<const Entry*, static_cast<std::size_t>(GateType::CUSTOM)> table{};
+    for (const auto& entry : entries)
+    {
+      table[static_cast<std::size_t>(entry.type)] = &entry;
+    }
+    return table;
+  }();
+
+  if (type != GateType::CUSTOM)
+  {
+    return by_type[static_cast<std::size_t>(type)];
+  }
+
+  if (!name.empty())
+  {
+    for (const auto& entry : entries)
     {
-      g->add_subgate(subgates.at(i)->name, board);
+      // Word-level primitives only stand in for chips they were matched with
+      // (see builtin::match), except mux_16 which was a built-in before them.
+      const bool by_name = entry.word == WordOp::NONE || entry.type == GateType::MUX_16;
+      if (entry.create != nullptr && by_name && name == entry.name) return &entry;
     }
+  }
+
+  return nullptr;
+}
+
+auto builtin::name_of(const Entry& entry) -> const std::string&
+{
+  // Built once from the list of entries, in the same order.
+  static const auto names = [] {
+    std::vector<std::string> list{};
+    for (const auto& each : entries)
+    {
+      list.emplace_back(each.name);
+    }
+    return list;
+  }();
+
+  return names[static_cast<std::size_t>(&entry - entries)];
+}
+
+auto Gate::set_name(std::string_view new_name) -> void
+{
+  // Built-ins keep going by the name of their entry until given another one.
+  if (design != nullptr || builtin_entry == nullptr || new_name != builtin_entry->name)
+  {
+    chip_design().name = new_name;
+  }
+
+  // Matched with a word-level primitive by function, not by name.
+  if (type == GateType::CUSTOM && builtin_entry != nullptr && builtin_entry->word != builtin::WordOp::NONE)
+  {
+    return;
+  }
 
-    g->construct_wire(this->wire_construction_recipe);
-   
+  builtin_entry = builtin::find(type, get_name());
+}
+
+std::unique_ptr<Gate> Gate::duplicate(Board* board)
+{
+  // Built-ins, and custom chips a built-in stands in for. The copy keeps the
+  // chip's name, which is what recipes and add_subgate know it by.
+  if (builtin_entry != nullptr && builtin_entry->create != nullptr)
+  {
+    auto copy = builtin_entry->create();
+    copy->set_name(get_name());
+    return copy;
+  }
+
+  // Finished chips only hand out their profile, the instance has nothing to copy.
+  if (auto chip_profile = get_profile())
+  {
+    return std::make_unique<Gate>(std::move(chip_profile));
+  }
+
+  // Not serialized, which means that we need to simulate it. 
+  // Add the subgates and copy the wiring.
+  auto g = std::make_unique<Gate>(input_pins.size(), output_pins.size(), this->type, get_name(), this->serialized);
+
+  if (design == nullptr)
+  {
     return g;
-  }  
+  }
+
+  for (std::size_t i = 0; i < design->subgate_count; i++)
+  {
+    g->add_subgate(design->subgates.at(i)->get_name(), board);
+  }
+
+  g->construct_wire(design->wire_construction_recipe);
+
+  return g;
 }
@@ -27,12 +27,15 @@
 #define GATE_H
 
 #include <memory>
+#include <string_view>
 #include <vector>
 #include <unordered_set>
 
 #include "common.hpp"
 #include "pin.hpp"
+#include "truth_table.hpp"
 #include "utils.hpp"
+#include "wire.hpp"
 #include "wire_info.hpp"
 
 /**
@@ -47,16 +50,113 @@ enum class GateType
   ROM_32K,
   REGISTER,
   MUX_16,
+  AND_16,
+  OR_16,
+  XOR_16,
+  NOT_16,
+  ADD_16,
+  INC_16,
+  OR_16_WAY,
   CUSTOM
 };
 
 class Board;
 
+namespace builtin
+{
+  struct Entry;
+
+  /**
+   * Entry of a built-in type (see builtin/registry.hpp). A custom chip gets the
+   * entry of the built-in with its name, if any, which stands in for it when
+   * duplicated. Word-level primitives are matched by function instead (see
+   * builtin::match).
+   */
+  auto find(GateType type, std::string_view name = {}) -> const Entry*;
+
+  /**
+   * Name of the entry, as the name of every built-in which goes by it.
+   */
+  auto name_of(const Entry& entry) -> const std::string&;
+}
+
+namespace netlist
+{
+  struct Netlist;
+  struct Aig;
+  struct Program;
+  class Interpreter;
+  class EventSimulator;
+  class NativeChip;
+  class NativeSimulator;
+}
+
+/**
+ * The immutable part of a finished chip, shared by all of its instances.
+ * An instance only carries its pins and simulation state on top of this.
+ */
+struct ChipProfile
+{
+  GateType                                   type;
+  std::string                                name;
+  std::size_t                                input_count;
+  std::size_t                                output_count;
+  const TruthTable*                          truth_table;  // Owned by the chip's image, null if not serialized.
+  std::shared_ptr<const netlist::Netlist>    netlist;      // Null if not flattened.
+  std::shared_ptr<const netlist::Aig>        aig;          // Null unless flattened and combinational.
+  std::shared_ptr<const netlist::Program>    program;      // Null unless flattened and not on a graph.
+  std::shared_ptr<const netlist::NativeChip> native;       // Null unless compiled to native code.
+  bool                                       event_driven; // See Gate::set_event_driven.
+  std::uint64_t                              content_hash; // See Gate::content_hash.
+};
+
+/**
+ * The part of a chip which only matters while building and compiling it: its
+ * recipe, subgates and wires, and what it was compiled into. Images, sketches
+ * and chips which aren't finished have one. Instances of a finished chip find
+ * their name and compiled forms in their ChipProfile, and built-ins go by the
+ * name of their entry, so neither carries one (see Gate::chip_design).
+ */
+struct ChipDesign
+{
+  std::string                                  name{};
+  WireConstructionInfo                         wire_construction_recipe{};
+  std::size_t                                  subgate_count{};
+  std::size_t                                  pin_count{};
+  std::vector<std::unique_ptr<Gate>>           subgates{};
+
+  /**
+   * Subgate and pin index of every subgate pin, in pin ID order (see Gate::get_pin).
+   * Counted from the first subgate pin, so adding pins to the chip itself
+   * doesn't move anything.
+   */
+  struct PinSlot
+  {
+    std::uint32_t subgate;
+    std::uint32_t index;
+  };
+
+  std::vector<PinSlot>                         subgate_inputs{};
+  std::vector<PinSlot>                         subgate_outputs{};
+  TruthTable                                   serialized_computation{};
+  std::shared_ptr<const netlist::Netlist>      flat_netlist{};
+  std::shared_ptr<const netlist::Program>      flat_program{};      // Null when there is a graph.
+  std::shared_ptr<const netlist::Aig>          flat_aig{};
+  std::shared_ptr<const netlist::NativeChip>   native_chip{};
+
+  /**
+   * Every wire of the recipe, grouped by source pin once indexed. The pins
+   * refer to their group through their inner/outer spans.
+   */
+  std::vector<Wire>                            wires{};
+  bool                                         wires_indexed{};
+};
+
 
 /**
  * A Gate represents a component board. Each component board consists of I/O ports,
  * subgates and wires. The gate also contains its wire construction recipe for the
- * sake of self replication.
+ * sake of self replication, in its design (see ChipDesign).
  */
 struct Gate
 {
@@ -64,44 +164,57 @@ struct Gate
    * Gate information.
    */
   GateType                                     type;
-  std::size_t                                  subgate_count{};
-  std::string                                  name{};
-  WireConstructionInfo                         wire_construction_recipe{};
-  std::size_t                                  pin_count{};
-  std::vector<std::unique_ptr<Gate>>           subgates{};
+  const builtin::Entry*                        builtin_entry{};     // See builtin::find.
   bool                                         serialized{};
-  std::vector<std::size_t>                     serialized_computation{};
-  std::vector<std::size_t>*                    serialized_computation_ptr{ nullptr };
+  bool                                         flattened{};
+  bool                                         oscillation_reported{};
 
   /**
-   * Input/Output ports and wires.
-   *
-   * NOTE: This information can probably be pulled out into a struct. The struct
-   * then can hold a pointer to an 'image/profile' of the gate (the Gate class).
-   * That will give it sufficient amount of information that is required for simulation.
-   * Then when we want to duplicate a chip, we can just duplicate the struct. This will
-   * help us avoid duplicating redundant information which only needs to be constructed once
-   * like wire_construction_recipe. There is no point for every single chip to be holding
-   * the same information
+   * Whether the second half of the input plane holds the inputs as of the last
+   * evaluation of a combinational chip, which has nothing to do until one of them
+   * changes (see handle_custom_type). Cleared whenever the chip or its outputs
+   * change under it.
+   */
+  bool                                         inputs_settled{};
+  const TruthTable*                            serialized_computation_ptr{ nullptr };
+  std::unique_ptr<netlist::Interpreter>        flat_interpreter{};
+  std::unique_ptr<netlist::EventSimulator>     flat_events{};       // Null unless event driven.
+  std::unique_ptr<netlist::NativeSimulator>    native_simulator{};
+
+  /**
+   * Shared information of a finished chip (see ChipProfile). Images build it on
+   * their first duplication, instances point at their image's profile instead of
+   * holding their own name, recipe and subgates.
+   */
+  std::shared_ptr<const ChipProfile>           profile{};
+
+  /**
+   * Null on instances of a finished chip and on built-ins, see chip_design.
+   */
+  std::unique_ptr<ChipDesign>                  design{};
+
+  /**
+   * Input/Output ports.
    */
+  std::vector<PinWord>                         input_plane{};
+  std::vector<PinWord>                         output_plane{};
   std::vector<Pin>                             input_pins{};
   std::vector<Pin>                             output_pins{};
-  std::vector<Wire*> wires;
-  
+
 
   explicit Gate(std::size_t ipc = 0,
                 std::size_t opc = 0,
                 GateType gate_type = GateType::CUSTOM,
                 const std::string& gate_name = "",
                 bool is_serialized = false
-    )
-    : type{ gate_type }
-    , input_pins(ipc, Pin(this))
-    , output_pins(opc, Pin())
-    , name{ gate_name }
-    , serialized{ is_serialized }
-  {
-  }
+    );
+
+  /**
+   * Instance of a finished chip.
+   */
+  explicit Gate(std::shared_ptr<const ChipProfile> chip_profile);
+
+  ~Gate();
 
   auto print_truth_table() -> void
   {
@@ -156,71 +269,220 @@ struct Gate
     return serialized;
   }
 
-  auto set_name(std::string_view new_name) -> void
+  auto is_flattened() const -> bool
   {
-    name = new_name;
+    return flattened;
   }
+
+  /**
+   * Compile the chip into a flat netlist of primitive cells. From then on the chip,
+   * and every duplicate made of it, is simulated on the netlist instead of walking
+   * the subgate tree.
+   *
+   * Combinational chips are also turned into an and-inverter graph, which is evaluated
+   * in one straight pass and holds no state of its own, so copies don't need a simulator.
+   *
+   * With optimize set the netlist goes through netlist::Optimizer first. Only the
+   * simulation uses the optimized form, the subgates are left as they are.
+   */
+  bool flatten(bool optimize = true);
+
+  /**
+   * Simulate the chip on the graph if there is one, otherwise on the netlist's
+   * bytecode (compiled here unless given).
+   */
+  void attach_netlist(std::shared_ptr<const netlist::Netlist> netlist, std::shared_ptr<const netlist::Aig> aig, std::shared_ptr<const netlist::Program> program = nullptr);
+
+  /**
+   * Set up this instance's own simulator for the netlist, running the given bytecode
+   * unless it is null (the chip is on a graph).
+   */
+  void start_netlist(const std::shared_ptr<const netlist::Program>& program);
+
+  /**
+   * Simulate the chip, and every duplicate made of it from now on, on the netlist's
+   * event-driven engine (see netlist::EventSimulator) instead of its bytecode or graph.
+   * Turning it off goes back to those.
+   */
+  void set_event_driven(bool on);
+
+  /**
+   * Settle the chip, or with cycles set run that many clock cycles (see tick).
+   */
+  void simulate_flattened(std::size_t cycles = 0);
+
+  void simulate_aig();
+
+  /**
+   * Simulate the chip, and every duplicate made of it from now on, on native code
+   * generated from its netlist (see netlist::compile_native).
+   */
+  void attach_native(std::shared_ptr<const netlist::NativeChip> chip);
+
+  void simulate_native(std::size_t cycles = 0);
+
+  /**
+   * Warn that the chip did not settle, once per instance.
+   */
+  void report_oscillation();
+
+  /**
+   * Rename the chip. A built-in standing in for it by name follows the new name,
+   * a word-level primitive it was matched with by function stays.
+   */
+  auto set_name(std::string_view new_name) -> void;
   
   const std::string& get_name() const
   {
-    return name;
+    if (profile != nullptr) return profile->name;
+    if (design != nullptr) return design->name;
+    return builtin::name_of(*builtin_entry);
   }
 
-  auto serialize() -> void
+  /**
+   * The chip's design, made on first use for a gate which had none (an instance
+   * or a built-in being rebuilt, renamed or serialized).
+   */
+  auto chip_design() -> ChipDesign&;
+
+  /**
+   * What the chip was compiled into, kept in its design or, on an instance of a
+   * finished chip, its profile. Null if it wasn't.
+   */
+  auto get_netlist() const -> const netlist::Netlist*
   {
-    uint64_t indicies = (2ULL << (static_cast<uint64_t>(input_pins.size()) - 1));
+    if (design != nullptr) return design->flat_netlist.get();
+    return (profile != nullptr) ? profile->netlist.get() : nullptr;
+  }
 
-    for (uint64_t i = 0; i < indicies; i++)
-    {
-      apply_input(input_pins.size(), static_cast<std::size_t>(i));
-      simulate();
-      serialized_computation.push_back(serialize_output());
-    }
-    this->serialized = true;
-    this->serialized_computation_ptr = &this->serialized_computation;
+  auto get_aig() const -> const netlist::Aig*
+  {
+    if (design != nullptr) return design->flat_aig.get();
+    return (profile != nullptr) ? profile->aig.get() : nullptr;
   }
 
-  inline auto serialize_output() -> std::size_t
+  /**
+   * Profile of this chip, only serialized or flattened chips are finished enough to have one.
+   */
+  auto get_profile() -> std::shared_ptr<const ChipProfile>;
+
+  void release_profile();
+
+  /**
+   * Hash of everything which defines the chip's behaviour: its name, pins, wiring
+   * and the content hashes of its subgates. Changing a chip changes the hash of
+   * every chip built out of it.
+   */
+  auto content_hash() const -> std::uint64_t;
+
+  /**
+   * Precompute the truth table of the chip.
+   * Combinational chips are evaluated 64 input rows at a time, spread over worker threads.
+   *
+   * Returns false if the serialization got cancelled, the chip is left as it was.
+   */
+  bool serialize(const SerializeOptions& options = {});
+
+  /**
+   * Serialize the chip with an already computed table.
+   */
+  auto set_truth_table(TruthTable table) -> void;
+
+  /**
+   * Whether the chip can be replaced by its truth table: flattened, with no more
+   * than input_limit inputs and nothing in it which holds state (dff, builtins
+   * with memory, feedback loops).
+   */
+  auto is_precomputable(std::size_t input_limit) const -> bool;
+
+  /**
+   * Whether the outputs only follow the inputs: serialized chips, and flattened
+   * chips with neither sequential cells nor feedback loops.
+   */
+  auto is_combinational() const -> bool;
+
+  /**
+   * Bus I/O: the pins [start, start + width) of the inputs or the outputs as one
+   * unsigned value, the first pin being the most significant bit. Only the last
+   * 64 pins of a wider range are read or written. The templated forms take the
+   * range at compile time and return the smallest type holding it.
+   */
+  template <std::size_t Start, std::size_t Width>
+  auto read_input_bus() const -> BusValue<Width>
   {
-    return pinvec_to_uint(output_pins, 0, output_pins.size());
+    return static_cast<BusValue<Width>>(plane_read<Start, Width>(input_plane.data()));
   }
 
-  inline auto serialize_input() -> std::size_t
+  template <std::size_t Start, std::size_t Width>
+  auto read_output_bus() const -> BusValue<Width>
   {
-    return pinvec_to_uint(input_pins, 0, input_pins.size());
+    return static_cast<BusValue<Width>>(plane_read<Start, Width>(output_plane.data()));
   }
 
-  auto simulate_serialized() -> void
+  template <std::size_t Start, std::size_t Width>
+  auto write_input_bus(PinWord value) -> void
   {
-    // Get serialized entry of the input.
-    auto serialized_input = serialize_input();
+    plane_write<Start, Width>(input_plane.data(), value);
+  }
 
-    // Retrieve the serialized output entry using the serialized input.
-    auto serialized_output = (*serialized_computation_ptr)[serialized_input];
+  template <std::size_t Start, std::size_t Width>
+  auto write_output_bus(PinWord value) -> void
+  {
+    plane_write<Start, Width>(output_plane.data(), value);
+  }
 
-    apply_output(static_cast<int>(output_pins.size()), serialized_output);
+  auto read_input_bus(std::size_t start, std::size_t width) const -> PinWord
+  {
+    return plane_extract(input_plane.data(), start, start + width);
   }
 
-  auto apply_input(int count, std::size_t mask) -> void
+  auto read_output_bus(std::size_t start, std::size_t width) const -> PinWord
   {
-    std::size_t index = 0;
-    while (count --> 0)
-    {
-      input_pins[index++].state = (((mask >> count ) & 1) == 1) ? PinState::ACTIVE : PinState::INACTIVE;
-    }
+    return plane_extract(output_plane.data(), start, start + width);
   }
 
-  auto apply_output(int count, std::size_t mask) -> void
+  auto write_input_bus(std::size_t start, std::size_t width, PinWord value) -> void
   {
-    std::size_t index = 0;
-    while (count --> 0)
-    {
-      output_pins[index].state = (((mask >> count ) & 1) == 1) ? PinState::ACTIVE : PinState::INACTIVE;
-      index++;
-    }
+    plane_insert(input_plane.data(), value, start, start + width);
+  }
+
+  auto write_output_bus(std::size_t start, std::size_t width, PinWord value) -> void
+  {
+    plane_insert(output_plane.data(), value, start, start + width);
+  }
+
+  auto simulate_serialized() -> void
+  {
+    // The whole input is the row, the whole row is the output.
+    const auto row = read_input_bus(0, input_pins.size());
+    write_output_bus(0, output_pins.size(), (*serialized_computation_ptr)[row]);
   }
 
-  void simulate(std::unordered_set<Gate*> was_visited = {});
+  void simulate();
+
+  /**
+   * Simulate as part of the walk of a chip which isn't flattened, was_visited
+   * holding the gates of the walk simulated so far. It comes back unchanged.
+   */
+  void simulate(std::unordered_set<Gate*>& was_visited);
+
+  /**
+   * Run whole clock cycles without going through the clock pin: the chip settles,
+   * every sequential cell samples its inputs before any of them updates its outputs,
+   * and the chip settles again. Each sequential cell is clocked once per cycle,
+   * whatever drives its clock pin (which should be left low).
+   *
+   * Custom chips are flattened first if they aren't yet.
+   */
+  void tick(std::size_t cycles = 1);
+
+  /**
+   * The two halves of a clock edge of a sequential built-in (see tick): sample()
+   * works out the next state from the input pins, commit() moves it to the outputs.
+   */
+  void sample();
+
+  void commit();
 
   auto reset() -> void
   {
@@ -229,6 +491,7 @@ struct Gate
     {
       output_pin.reset();
     }
+    inputs_settled = false;
   }
 
 
@@ -238,7 +501,7 @@ struct Gate
     auto old_input_count = input_pins.size();
 
     // Update output pins recipe for coherency.
-    for (auto& [a, b] : wire_construction_recipe)
+    for (auto& [a, b] : chip_design().wire_construction_recipe)
     {
       if (a >= old_input_count && a < INPUT_PIN_LIMIT)
       {
@@ -252,9 +515,11 @@ struct Gate
 
     while (n --> 0)
     {
-      pin_count++;
+      chip_design().pin_count++;
       input_pins.emplace_back();
     }
+
+    bind_pins();
   }
 
   auto add_output_pin(int n = 1) -> void
@@ -263,7 +528,7 @@ struct Gate
     auto old_output_count = output_pins.size() + INPUT_PIN_LIMIT;
 
     // Update output pins recipe for coherency.
-    for (auto& [a, b] : wire_construction_recipe)
+    for (auto& [a, b] : chip_design().wire_construction_recipe)
     {
       if (a >= old_output_count)
       {
@@ -277,73 +542,78 @@ struct Gate
 
     while (n --> 0)
     {
-      pin_count++;
+      chip_design().pin_count++;
       output_pins.emplace_back();
     }
 
+    bind_pins();
   }
 
+  /**
+   * Point every pin at its bit, the planes grow along with the pin count. The
+   * input plane is twice as long as its pins need, see inputs_settled.
+   */
+  auto bind_pins() -> void
+  {
+    input_plane.resize(2 * plane_words(input_pins.size()), 0);
+    output_plane.resize(plane_words(output_pins.size()), 0);
+    inputs_settled = false;
+
+    for (std::size_t i = 0; i < input_pins.size(); i++) input_pins[i].bind(input_plane.data(), i);
+    for (std::size_t i = 0; i < output_pins.size(); i++) output_pins[i].bind(output_plane.data(), i);
+  }
+
+  /**
+   * Pin IDs count the chip's own pins first, then those of each subgate in order
+   * (inputs below INPUT_PIN_LIMIT, outputs above it).
+   */
   auto get_pin(std::size_t pin) -> Pin*
   {
-    if (INPUT_PIN_LIMIT > pin)
-    {
-      std::size_t range = input_pins.size();
+    const bool input = INPUT_PIN_LIMIT > pin;
+    if (!input) pin -= INPUT_PIN_LIMIT;
 
-      if ( range > pin )
-      {
-        return &input_pins[pin];
-      }
-      else
-      {
-        for (auto& subgate : subgates)
-        {
-          auto s = subgate->input_pins.size();
-          range += s;
-          if ( range > pin )
-          {
-            range -= s;
-            return &subgate->input_pins.at(pin - range);
-          }
-        }
-      }
-    }
-    else
+    auto& own = input ? input_pins : output_pins;
+    if (pin < own.size())
     {
-      pin -= INPUT_PIN_LIMIT;
+      return &own[pin];
+    }
 
-      std::size_t range = output_pins.size();
+    if (design == nullptr)
+    {
+      return nullptr;
+    }
 
-      if ( range > pin )
-      {
-        auto w = &output_pins[pin];
-        return w;
-      }
-      else
-      {
-        for (auto& subgate : subgates)
-        {
-          auto s = subgate->output_pins.size();
-          range += s;
-          if ( range > pin )
-          {
-            range -= s;
-            return &subgate->output_pins.at(pin - range);
-          }
-        }
-      }
+    const auto& slots = input ? design->subgate_inputs : design->subgate_outputs;
+    pin -= own.size();
+    if (pin >= slots.size())
+    {
+      return nullptr;
     }
 
-    return nullptr;
+    const auto [subgate, index] = slots[pin];
+    auto& chip = *design->subgates[subgate];
+    return input ? &chip.input_pins[index] : &chip.output_pins[index];
   }
 
   auto clear_wires() -> void
   {
-    wires.clear();
+    if (design == nullptr) return;
+    design->wires.clear();
+    design->wires_indexed = false;
   }
 
+  auto owns_pin(const Pin* pin) const -> bool
+  {
+    return (pin >= input_pins.data() && pin < input_pins.data() + input_pins.size())
+        || (pin >= output_pins.data() && pin < output_pins.data() + output_pins.size());
+  }
+
+  auto index_wires() -> void;
+
   auto construct_wire(WireConstructionInfo& wire_info) -> void
   {
     clear_wires();
+    chip_design().wires.reserve(wire_info.size());
     for (auto [src, dest] : wire_info)
     {
       if (!wire_pins(src, dest))
@@ -369,7 +639,7 @@ struct Gate
       return false;
     }
 
-    wire_construction_recipe.push_back({p1, p2});
+    chip_design().wire_construction_recipe.push_back({p1, p2});
 
     return connect_pins(pa, pb);
   }
@@ -383,7 +653,7 @@ struct Gate
 
   auto get_pin_state(std::size_t input_id) -> PinState
   {
-    return input_pins.at(input_id).state;
+    return input_pins.at(input_id).get_state();
   }
 
   auto toggle_pin(std::size_t input_id) -> bool
@@ -395,50 +665,21 @@ struct Gate
 
   auto add_subgate(Gate* gate, Board* board = nullptr) -> std::size_t
   {
-  	return add_subgate(gate->name, board);
+  	return add_subgate(gate->get_name(), board);
   }
 
   std::size_t add_subgate(std::string_view gate_name, Board* board = nullptr);
 
   std::unique_ptr<Gate> duplicate(Board* board = nullptr);
 
-  void handle_custom_type(std::unordered_set<Gate*> was_visited);
-
-  /**
-   * Built-in type handlers.
-   * TODO: Maybe abstract this out later.
-   */
-  auto handle_nand() -> void
-  {
-    output_pins[0].state = (!(input_pins[0].is_active() && input_pins[1].is_active()))
-                         ? PinState::ACTIVE
-                         : PinState::INACTIVE;
-  }
-
-  auto handle_dff() -> void
-  {
-    if (input_pins[1].is_active())
-    {
-      output_pins[0].state = input_pins[0].get_state();
-    }
-  }
-
-  void handle_pc();
-
-  void handle_ram_16k();
-
-  void handle_rom_32k();
-
-  auto handle_mux_16() -> void;
-
-  auto handle_register() -> void;
+  void handle_custom_type(std::unordered_set<Gate*>& was_visited);
 
   auto input_info() -> void
   {
     log("Input Info:\n");
     for (std::size_t count = 0; count < input_pins.size(); count++)
 		{
-			log("pin[", count, "] ", input_pins[count].state == PinState::ACTIVE ? 1 : 0, "\n");
+			log("pin[", count, "] ", input_pins[count].is_active() ? 1 : 0, "\n");
 		}
   }
 
@@ -447,29 +688,31 @@ struct Gate
     log("output Info:\n");
     for (std::size_t count = 0; count < output_pins.size(); count++)
 		{
-			log("pin[", count + INPUT_PIN_LIMIT, "] ", output_pins[count].state == PinState::ACTIVE ? 1 : 0, "\n");
+			log("pin[", count + INPUT_PIN_LIMIT, "] ", output_pins[count].is_active() ? 1 : 0, "\n");
 		}
   }
 
 
   auto subgates_info() -> void
   {
+    if (design == nullptr) return;
+
     auto count = input_pins.size();
     auto output_count = output_pins.size();
-    for (auto i=0; i < subgates.size(); i++)
+    for (auto i=0; i < design->subgates.size(); i++)
     {
-      const auto& subgate = subgates.at(i);
+      const auto& subgate = design->subgates.at(i);
       newline();
-      log(BLOCK, " Subgate[", i, " : ", subgate->name, "] ", BLOCK, "\n");
+      log(BLOCK, " Subgate[", i, " : ", subgate->get_name(), "] ", BLOCK, "\n");
   		for (const auto& pin : subgate->input_pins)
   		{
-			  log("    pin[", count, "] ", pin.state == PinState::ACTIVE ? 1 : 0, "\n");
+			  log("    pin[", count, "] ", pin.is_active() ? 1 : 0, "\n");
   			count++;
   		}
       log("Exposed output pins:\n");
   		for (const auto& pin : subgate->output_pins)
   		{
-  			log("    pin[", output_count + INPUT_PIN_LIMIT, "] ", pin.state == PinState::ACTIVE ? 1 : 0, "\n");
+  			log("    pin[", output_count + INPUT_PIN_LIMIT, "] ", pin.is_active() ? 1 : 0, "\n");
   			output_count++;
   		}
     }  
@@ -477,13 +720,15 @@ struct Gate
 
   auto subgates_brief() -> void
   {
+    if (design == nullptr) return;
+
     auto count = input_pins.size();
     auto output_count = output_pins.size();
-    for (auto i=0; i < subgates.size(); i++)
+    for (auto i=0; i < design->subgates.size(); i++)
     {
-      const auto& subgate = subgates.at(i);
+      const auto& subgate = design->subgates.at(i);
       newline();
-      log(BLOCK, " Subgate[", i, " : ", subgate->name, "] ", BLOCK, "\n");
+      log(BLOCK, " Subgate[", i, " : ", subgate->get_name(), "] ", BLOCK, "\n");
   		for (const auto& pin : subgate->input_pins)
   		{
 			  log("> ", count, '\n');
@@ -512,8 +757,14 @@ struct Gate
 
   auto wire_info() -> void
   {
-    log("Wire count: ", wires.size(), '\n');
-    for (auto [src, dest] : wire_construction_recipe)
+    if (design == nullptr)
+    {
+      log("Wire count: 0\n");
+      return;
+    }
+
+    log("Wire count: ", design->wires.size(), '\n');
+    for (auto [src, dest] : design->wire_construction_recipe)
     {
       std::cout << src << " <---> " << dest << '\n';
     }  
@@ -522,8 +773,9 @@ struct Gate
   // Prints information about the current gate.
   auto info() -> void
   {
-    log(BLOCK, " Gate ", name, BLOCK, '\n');
+    log(BLOCK, " Gate ", get_name(), BLOCK, '\n');
     log("Is serialized: ", (serialized ? "yes" : "no"), '\n');
+    log("Is flattened: ", (flattened ? "yes" : "no"), '\n');
     wire_info();
     input_pin_address_info();
 
@@ -531,7 +783,7 @@ struct Gate
 		auto count = 0;
 		for (const auto& pin : input_pins)
 		{
-			log("pin[", count, "] ", pin.state == PinState::ACTIVE ? 1 : 0, "\n");
+			log("pin[", count, "] ", pin.is_active() ? 1 : 0, "\n");
 			count++;
 		}
 
@@ -539,7 +791,7 @@ struct Gate
     log(BLOCK, " Output Pins ", BLOCK, '\n');
 		for (const auto& pin : output_pins)
 		{
-			log("pin[", output_count + INPUT_PIN_LIMIT, "] ", pin.state == PinState::ACTIVE ? 1 : 0, "\n");
+			log("pin[", output_count + INPUT_PIN_LIMIT, "] ", pin.is_active() ? 1 : 0, "\n");
 			output_count++;
 		}
 
@@ -324,7 +324,7 @@ std::pair<std::size_t, PinGui*> get_pin(const sf::Vector2f& pos)
       }
 
       ComponentRecipe recipe = ComponentRecipe::construct_recipe(current);
-      recipe.set_wire_configuration(current->wire_construction_recipe);
+      recipe.set_wire_configuration(current->chip_design().wire_construction_recipe);
       recipe.create_recipe_file();
 
       clear();
@@ -86,13 +86,13 @@ public:
 
       // std::cout << BLOCK << " [ UPDATING COMPONENT: `" << m_component->name << "` ] " << BLOCK  << BLOCK << BLOCK << '\n';
       auto input_bits = m_input_pins.get_bits();    
-      m_component->apply_input(m_input_pins.size(), input_bits);
+      m_component->write_input_bus(0, m_input_pins.size(), input_bits);
       // m_component->input_info();
       // m_component->wire_info();
       // m_component->subgates_brief();
 
       m_component->simulate();
-      auto output_bits = m_component->serialize_output();
+      auto output_bits = m_component->read_output_bus(0, m_component->output_pins.size());
       m_output_pins.apply_bits(output_bits);
 
       // m_component->output_info();
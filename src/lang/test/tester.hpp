@@ -242,7 +242,7 @@ class Tester : public BaseParser<TestTokenType>
                       [&](const auto& bus) { values.insert(bus.bus_name); });
 
         const auto key = board_ptr->context().second->add_subgate(image->gate, board_ptr);
-        auto chip = board_ptr->context().second->subgates[key].get();
+        auto chip = board_ptr->context().second->design->subgates[key].get();
 
         variables[varname] = { image, chip, std::move(values) };
     }
@@ -284,6 +284,29 @@ class Tester : public BaseParser<TestTokenType>
         expect_semicolon("Expected semicolon for EVAL statement.");
     }
 
+    auto TICK_impl(std::size_t cycles) noexcept -> void
+    {
+        for (auto& [_, variable] : variables)
+        {
+            variable.chip->tick(cycles);
+        }
+    }
+
+    auto TICK_statement() noexcept -> void
+    {
+        // One clock cycle, or as many as given.
+        std::size_t cycles = 1;
+        if (match(TestTokenType::Number))
+        {
+            cycles = std::stoull(previous.lexeme);
+        }
+
+        expect_semicolon("Expected semicolon for TICK statement.");
+
+        if (!has_error)
+            TICK_impl(cycles);
+    }
+
     // TODO: Make this return variable information.
     auto parse_variable() noexcept -> Value
     {
@@ -359,21 +382,11 @@ class Tester : public BaseParser<TestTokenType>
                 if (bus.has_value())
                 {
                     const auto& [name, start, size] = bus.value();
-                    const auto& pins = variable.chip->input_pins;
                     const bool is_input { start < MAX_INPUT_PINS };
 
-
-                    std::size_t offset = is_input 
-                                       ? 0 
-                                       : MAX_INPUT_PINS;
-
-                    std::vector<Pin>& target = is_input 
-                                             ? variable.chip->input_pins 
-                                             : variable.chip->output_pins;
-
-                    std::size_t so = pinvec_to_uint(target, start - offset, start + size - offset);
-
-                    return so;
+                    return is_input 
+                         ? variable.chip->read_input_bus(start, size) 
+                         : variable.chip->read_output_bus(start - MAX_INPUT_PINS, size);
                 }
                 else if (pin.has_value())
                 {
@@ -442,7 +455,6 @@ class Tester : public BaseParser<TestTokenType>
         if (bus.has_value())
         {
             const auto& [name, start, size] = bus.value();
-            auto& pins = variable.chip->input_pins;
 
             if ((int_val >> size) > 0)
             {
@@ -451,13 +463,13 @@ class Tester : public BaseParser<TestTokenType>
             }
 
             // Apply bitmask.
-            set_pinvec(int_val, pins, start, start+size);
+            variable.chip->write_input_bus(start, size, int_val);
         }
         else if (pin.has_value())
         {
             const auto pin_number = pin.value().pin_number;
 
-            variable.chip->input_pins[pin_number].state = (int_val == 1) ? PinState::ACTIVE : PinState::INACTIVE;
+            variable.chip->input_pins[pin_number].set(int_val == 1);
         }
         else
         {
@@ -608,6 +620,10 @@ class Tester : public BaseParser<TestTokenType>
             {
                 EVAL_statement();
             }
+            else if (match(TestTokenType::Tick))
+            {
+                TICK_statement();
+            }
             else if (match(TestTokenType::Require))
             {
                 REQUIRE_statement();
@@ -22,13 +22,23 @@
  * SOFTWARE.
  */
 
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <iostream>
 #include <string>
 #include <string_view>
 #include <filesystem>
 
 #include "common.hpp" 
+#include "batch.hpp"
 #include "board.hpp"
+#include "netlist/aig.hpp"
+#include "netlist/bit_parallel.hpp"
+#include "netlist/compiler.hpp"
+#include "netlist/kernel.hpp"
+#include "netlist/native.hpp"
+#include "netlist/netlist.hpp"
 
 #ifdef GUI_ENABLED
 #include "gui/driver.hpp"
@@ -276,15 +286,417 @@ void serialize(RawParser& parser)
 
 	if (auto component = board->get_component(name); component != nullptr)
 	{
-		component->serialize();
+		// Ctrl-C abandons the serialization instead of the whole session.
+		static std::atomic<bool> cancel_serialize{};
+		cancel_serialize = false;
+		const auto previous_handler = std::signal(SIGINT, [](int) { cancel_serialize = true; });
+
+		SerializeOptions options{};
+		options.cancel = &cancel_serialize;
+		options.progress = [last = std::size_t{ 101 }](std::size_t done, std::size_t rows) mutable {
+			const auto percent = done * 100 / rows;
+			if (rows > netlist::TABULATE_CHUNK_ROWS && percent != last)
+			{
+				last = percent;
+				print("\rSerializing... ", percent, "%");
+				std::cout.flush();
+			}
+		};
+
+		const bool completed = component->serialize(options);
+		std::signal(SIGINT, previous_handler);
+		print('\r');
+
+		if (!completed)
+		{
+			log("Serialization of `", name, "` cancelled.");
+			return;
+		}
+
 		// component->print_truth_table();
-		log("Component `", name, "` serialized!");
+		log("Component `", name, "` serialized! (", component->serialized_computation_ptr->memory(), " bytes)");
 	}
 	else
 	{
 		log("Component with given name `", name, "` not found!");
 	}}
 
+void flatten(RawParser& parser)
+{
+	auto board = Board::instance();
+	const auto token = parser.advance_token();
+
+	if (token.type != RawTokenType::Identifier)
+	{
+		error("Please input a valid component name.");
+		return;
+	}
+
+	// Get the component name.
+	const auto& name = token.lexeme;
+
+	if (auto component = board->get_component(name); component != nullptr)
+	{
+		if (!component->flatten(board->optimize_netlists))
+		{
+			error("Component `" + name + "` is a primitive, nothing to flatten.");
+			return;
+		}
+
+		const auto& netlist = *component->get_netlist();
+		log("Component `", name, "` flattened! (", netlist.cells.size(), " cells, ", netlist.net_count, " nets, ", netlist.level_count(), " levels, ", netlist.loop_count(), " feedback loops)");
+
+		if (component->get_aig() != nullptr)
+		{
+			log("Simulated as an and-inverter graph of ", component->get_aig()->ands.size(), " nodes.");
+		}
+	}
+	else
+	{
+		log("Component with given name `", name, "` not found!");
+	}
+}
+
+void compile_native(RawParser& parser)
+{
+	auto board = Board::instance();
+	const auto token = parser.advance_token();
+
+	if (token.type != RawTokenType::Identifier)
+	{
+		error("Please input a valid component name.");
+		return;
+	}
+
+	const auto& name = token.lexeme;
+	auto component = board->get_component(name);
+
+	if (component == nullptr)
+	{
+		log("Component with given name `", name, "` not found!");
+		return;
+	}
+
+	if (component->is_serialized())
+	{
+		error("Component `" + name + "` is precomputed already, a table lookup is as fast as it gets.");
+		return;
+	}
+
+	if (!component->is_flattened() && !component->flatten(board->optimize_netlists))
+	{
+		error("Component `" + name + "` is a primitive, nothing to compile.");
+		return;
+	}
+
+	log("Compiling `", name, "` to native code...");
+
+	std::string message{};
+	auto chip = netlist::compile_native(component->chip_design().flat_netlist, message);
+
+	if (chip == nullptr)
+	{
+		error("Failed to compile `" + name + "`: " + message);
+		return;
+	}
+
+	const auto path = chip->path.string();
+	component->attach_native(std::move(chip));
+	component->release_profile();
+	log("Component `", name, "` runs on native code! (", path, ")");
+}
+
+void check_kernel(RawParser& parser)
+{
+	auto board = Board::instance();
+	const auto token = parser.advance_token();
+
+	if (token.type != RawTokenType::Identifier)
+	{
+		error("Please input a valid component name.");
+		return;
+	}
+
+	const auto& name = token.lexeme;
+	auto component = board->get_component(name);
+
+	if (component == nullptr)
+	{
+		log("Component with given name `", name, "` not found!");
+		return;
+	}
+
+	if (!netlist::has_avx2_kernel())
+	{
+		log("This CPU has no AVX2, the scalar gate kernel is the only one.");
+		return;
+	}
+
+	if (!component->is_flattened() && !component->flatten(board->optimize_netlists))
+	{
+		error("Component `" + name + "` is a primitive, there are no gates to check.");
+		return;
+	}
+
+	constexpr std::size_t passes = 1000;
+	const auto& flat = *component->get_netlist();
+	const netlist::GateLevels gates{ flat };
+	const auto mismatches = netlist::compare_kernels(flat, passes);
+
+	if (mismatches != 0)
+	{
+		error("The AVX2 and scalar gate kernels disagree on " + std::to_string(mismatches) + " nets of `" + name + "`!");
+		return;
+	}
+
+	log("The AVX2 and scalar gate kernels agree on `", name, "` (", gates.out.size(), " gates, ", passes, " random passes of 64 lanes).");
+}
+
+void select_engine(RawParser& parser)
+{
+	auto board = Board::instance();
+	const auto token = parser.advance_token();
+
+	if (token.type != RawTokenType::Identifier)
+	{
+		error("Please input a valid component name.");
+		return;
+	}
+
+	const auto name = token.lexeme;
+	const auto engine = parser.advance_token().lexeme;
+
+	if (engine != "event" && engine != "bytecode")
+	{
+		error("Please input either `event` or `bytecode`.");
+		return;
+	}
+
+	auto component = board->get_component(name);
+
+	if (component == nullptr)
+	{
+		log("Component with given name `", name, "` not found!");
+		return;
+	}
+
+	if (component->is_serialized())
+	{
+		error("Component `" + name + "` is precomputed already, a table lookup is as fast as it gets.");
+		return;
+	}
+
+	if (!component->is_flattened() && !component->flatten(board->optimize_netlists))
+	{
+		error("Component `" + name + "` is a primitive, there is no netlist to run.");
+		return;
+	}
+
+	component->set_event_driven(engine == "event");
+	component->release_profile();
+
+	if (engine == "event")
+	{
+		log("Component `", name, "` runs on the event-driven engine.");
+	}
+	else if (component->get_aig() != nullptr)
+	{
+		log("Component `", name, "` runs on its and-inverter graph.");
+	}
+	else
+	{
+		log("Component `", name, "` runs on the bytecode interpreter.");
+	}
+}
+
+void check_equivalence(RawParser& parser)
+{
+	auto board = Board::instance();
+	const auto first = parser.advance_token();
+	const auto second = parser.advance_token();
+
+	if (first.type != RawTokenType::Identifier || second.type != RawTokenType::Identifier)
+	{
+		error("Please input the names of the two components to compare.");
+		return;
+	}
+
+	std::shared_ptr<const netlist::Aig> graphs[2]{};
+
+	for (std::size_t i = 0; i < 2; i++)
+	{
+		const auto& name = (i == 0 ? first : second).lexeme;
+		auto component = board->get_component(name);
+
+		if (component == nullptr)
+		{
+			log("Component with given name `", name, "` not found!");
+			return;
+		}
+
+		if (component->is_serialized())
+		{
+			graphs[i] = netlist::build_aig(*component->serialized_computation_ptr);
+		}
+		else if (component->get_aig() != nullptr)
+		{
+			graphs[i] = component->chip_design().flat_aig;
+		}
+		else
+		{
+			// Not flattened, or not simulated on a graph: compile one just for the comparison.
+			auto compiled = netlist::Compiler(*component).compile();
+			graphs[i] = (compiled == nullptr) ? nullptr : netlist::build_aig(*compiled);
+		}
+
+		if (graphs[i] == nullptr)
+		{
+			error("Component `" + name + "` is not combinational, only combinational chips can be compared.");
+			return;
+		}
+	}
+
+	if (graphs[0]->input_count != graphs[1]->input_count || graphs[0]->outputs.size() != graphs[1]->outputs.size())
+	{
+		log("Components `", first.lexeme, "` and `", second.lexeme, "` have different pins.");
+		return;
+	}
+
+	const auto result = netlist::check_equivalence(*graphs[0], *graphs[1]);
+
+	if (result.equivalent)
+	{
+		log("Components `", first.lexeme, "` and `", second.lexeme, "` are ", (result.exhaustive ? "equivalent" : "equivalent on every sampled input"), " (", result.vectors, " vectors).");
+		return;
+	}
+
+	std::string counterexample{};
+	for (const auto bit : result.counterexample)
+	{
+		counterexample += bit ? '1' : '0';
+	}
+	log("Components `", first.lexeme, "` and `", second.lexeme, "` differ on input ", counterexample, ".");
+}
+
+void run_batch(RawParser& parser)
+{
+	auto board = Board::instance();
+	const auto chip_token = parser.advance_token();
+	const auto file_token = parser.advance_token();
+
+	if (chip_token.type != RawTokenType::Identifier || file_token.type != RawTokenType::Identifier)
+	{
+		error("Please input a component name and the name of its stimulus file.");
+		return;
+	}
+
+	const auto& name = chip_token.lexeme;
+	auto component = board->get_component(name);
+
+	if (component == nullptr)
+	{
+		log("Component with given name `", name, "` not found!");
+		return;
+	}
+
+	// Only finished chips can be instantiated on several threads, flatten the rest.
+	if (component->type == GateType::CUSTOM && !component->is_serialized() && !component->is_flattened() && !component->flatten(board->optimize_netlists))
+	{
+		error("Component `" + name + "` can't be flattened.");
+		return;
+	}
+
+	const auto stimulus_path = SCRIPTS_DIR + SEPERATOR + file_token.lexeme + STIMULUS_EXTENSION;
+	const auto waveform_path = SCRIPTS_DIR + SEPERATOR + file_token.lexeme + WAVEFORM_EXTENSION;
+
+	std::string message{};
+	const auto stimuli = batch::read_stimuli(stimulus_path, component->input_pins.size(), message);
+
+	if (!stimuli.has_value())
+	{
+		error(message);
+		return;
+	}
+
+	std::size_t steps = 0;
+	for (const auto& stimulus : *stimuli) steps += stimulus.steps();
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto results = batch::run(*component, *stimuli);
+	const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (!results.has_value())
+	{
+		error("Component `" + name + "` can't run as a batch.");
+		return;
+	}
+
+	if (!batch::write_waveforms(waveform_path, *results))
+	{
+		error("Unable to write `" + waveform_path + "`.");
+		return;
+	}
+
+	log("Ran ", stimuli->size(), " instances of `", name, "` for ", steps, " steps in ", elapsed, " ms. (", waveform_path, ")");
+}
+
+void set_precompute_limit(RawParser& parser)
+{
+	const auto token = parser.advance_token();
+
+	if (token.type != RawTokenType::Number)
+	{
+		error("Please input the maximum number of inputs.");
+		return;
+	}
+
+	try
+	{
+		Board::instance()->precompute_input_limit = std::stoul(token.lexeme);
+	}
+	catch (const std::out_of_range&)
+	{
+		error("The maximum number of inputs is too large.");
+		return;
+	}
+
+	if (Board::instance()->precompute_input_limit == 0)
+	{
+		log("Chips loaded from now on will only be precomputed when their recipe asks for it.");
+		return;
+	}
+
+	log("Combinational chips with up to ", token.lexeme, " inputs will be precomputed when loaded.");
+}
+
+void set_optimize(RawParser& parser)
+{
+	const auto token = parser.advance_token();
+
+	if (token.lexeme != "on" && token.lexeme != "off")
+	{
+		error("Please input either `on` or `off`.");
+		return;
+	}
+
+	Board::instance()->optimize_netlists = token.lexeme == "on";
+	log("Netlist optimization turned ", token.lexeme, " for chips loaded from now on.");
+}
+
+void set_primitives(RawParser& parser)
+{
+	const auto token = parser.advance_token();
+
+	if (token.lexeme != "on" && token.lexeme != "off")
+	{
+		error("Please input either `on` or `off`.");
+		return;
+	}
+
+	Board::instance()->word_primitives = token.lexeme == "on";
+	log("Word-level primitives turned ", token.lexeme, " for chips loaded from now on.");
+}
+
 void handle_input(RawParser& parser, std::string_view str)
 {
 	parser.set_source(std::string(str));
@@ -301,6 +713,15 @@ void handle_input(RawParser& parser, std::string_view str)
 		desc("test        <chip>", "Run test file.");
 		desc("load        <chip>", "Load the specified chip.");
 		desc("compile     <file>", "Compile the hdl file with the given name.");
+		desc("flatten     <chip>", "Simulate the chip on a flat netlist of primitive cells.");
+		desc("native      <chip>", "Compile the chip to native code with the system compiler and simulate it on that.");
+		desc("engine <chip> <event|bytecode>", "Simulate the chip on the event-driven engine, or back on the default one.");
+		desc("kernel      <chip>", "Check that the AVX2 gate kernel computes the same as the scalar one on the chip.");
+		desc("equiv <chip> <chip>", "Check whether two combinational chips compute the same function.");
+		desc("batch <chip> <file>", "Run the chip once per stimulus in scripts/<file>.stim in parallel, outputs go to scripts/<file>.wave.");
+		desc("autoprecompute <n>", "Precompute combinational chips with at most n inputs on load, 0 to disable.");
+		desc("optimize  <on|off>", "Optimize the netlists of chips loaded from now on (default on).");
+		desc("primitives<on|off>", "Run copies of 16-bit chips equivalent to a word primitive as that primitive (default on).");
 	CASE("info")
 		log("Gate Recipe Directory: ", GATE_RECIPE_DIRECTORY);
 	CASE("test")
@@ -313,6 +734,24 @@ void handle_input(RawParser& parser, std::string_view str)
 		running = false;
 	CASE("serialize")
 		serialize(parser);
+	CASE("flatten")
+		flatten(parser);
+	CASE("native")
+		compile_native(parser);
+	CASE("engine")
+		select_engine(parser);
+	CASE("kernel")
+		check_kernel(parser);
+	CASE("equiv")
+		check_equivalence(parser);
+	CASE("batch")
+		run_batch(parser);
+	CASE("autoprecompute")
+		set_precompute_limit(parser);
+	CASE("optimize")
+		set_optimize(parser);
+	CASE("primitives")
+		set_primitives(parser);
 	CASE("list")
 		show_list(parser);
 	CASE("load")
@@ -338,7 +777,9 @@ void init()
 
 	for (const auto& gate : std::filesystem::directory_iterator(gate_sketch_dir))
   {
-		if (gate.path().extension() == GATE_EXTENSION)
+		// Skip sketches which were already pulled in through a `need`, reloading them
+		// would free the truth tables that the chips loaded so far point at.
+		if (gate.path().extension() == GATE_EXTENSION && !Board::instance()->found(gate.path().stem().string()))
 		{
 			run_file(gate.path());
 		}
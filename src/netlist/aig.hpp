@@ -0,0 +1,641 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_AIG_H
+#define NETLIST_AIG_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../gate.hpp"
+#include "../builtin/registry.hpp"
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * A literal is a node index shifted left once, the low bit inverts it.
+ * Node 0 is the constant false, so literal 0 is false and literal 1 is true.
+ */
+using AigLiteral = std::uint32_t;
+
+constexpr AigLiteral AIG_FALSE{ 0 };
+constexpr AigLiteral AIG_TRUE{ 1 };
+
+/**
+ * Graphs with more ANDs than this are not worth it, the netlist looks wide tables
+ * up in one go where the graph has to expand them into trees of muxes.
+ */
+constexpr std::size_t AIG_AND_LIMIT{ 1 << 16 };
+
+/**
+ * Chips with at most this many inputs are compared on every input combination.
+ */
+constexpr std::size_t EQUIVALENCE_EXHAUSTIVE_LIMIT{ 24 };
+
+/**
+ * Number of 64 vector batches compared when the chips are too wide to enumerate.
+ */
+constexpr std::size_t EQUIVALENCE_RANDOM_BATCHES{ 1 << 14 };
+
+/**
+ * Decision diagram nodes prove_equivalence may create before giving up.
+ */
+constexpr std::size_t BDD_NODE_LIMIT{ 1 << 20 };
+
+/**
+ * And-inverter graph of a combinational chip: every node past the inputs is the
+ * AND of two (possibly inverted) earlier nodes. Unlike a truth table its size
+ * doesn't depend on the number of inputs, so it can stand in for chips which
+ * are too wide to tabulate.
+ *
+ * Nodes: 0 is constant, 1..input_count are the inputs, ANDs follow in
+ * topological order.
+ */
+struct Aig
+{
+  std::size_t                                    input_count{};
+  std::vector<std::pair<AigLiteral, AigLiteral>> ands{};
+  std::vector<AigLiteral>                        outputs{};
+
+  auto node_count() const -> std::size_t
+  {
+    return 1 + input_count + ands.size();
+  }
+
+  /**
+   * Evaluate 64 input vectors at once, nodes must hold node_count() words.
+   * Bit L of inputs[i] is input i of vector L.
+   */
+  auto evaluate(const std::uint64_t* inputs, std::uint64_t* nodes, std::uint64_t* results) const -> void
+  {
+    nodes[0] = 0;
+    for (std::size_t i = 0; i < input_count; i++)
+    {
+      nodes[1 + i] = inputs[i];
+    }
+
+    auto* node = nodes + 1 + input_count;
+    for (const auto& [a, b] : ands)
+    {
+      *node++ = literal(nodes, a) & literal(nodes, b);
+    }
+
+    for (std::size_t o = 0; o < outputs.size(); o++)
+    {
+      results[o] = literal(nodes, outputs[o]);
+    }
+  }
+
+  static auto literal(const std::uint64_t* nodes, AigLiteral lit) -> std::uint64_t
+  {
+    // All ones when the literal is inverted.
+    return nodes[lit >> 1] ^ (0 - static_cast<std::uint64_t>(lit & 1));
+  }
+};
+
+/**
+ * Builds an Aig with structural hashing: an AND of the same two literals is only
+ * ever created once, and the trivial cases (constants, x & x, x & ~x) fold away.
+ */
+class AigBuilder
+{
+public:
+  explicit AigBuilder(std::size_t input_count)
+  : aig(std::make_shared<Aig>())
+  {
+    aig->input_count = input_count;
+  }
+
+  auto input(std::size_t index) const -> AigLiteral
+  {
+    return static_cast<AigLiteral>((1 + index) << 1);
+  }
+
+  static auto invert(AigLiteral a) -> AigLiteral
+  {
+    return a ^ 1;
+  }
+
+  auto land(AigLiteral a, AigLiteral b) -> AigLiteral
+  {
+    if (a > b) std::swap(a, b);
+
+    if (a == AIG_FALSE) return AIG_FALSE;
+    if (a == AIG_TRUE) return b;
+    if (a == b) return a;
+    if (a == invert(b)) return AIG_FALSE;
+
+    const auto key = (static_cast<std::uint64_t>(a) << 32) | b;
+    if (auto it = strash.find(key); it != strash.end())
+    {
+      return it->second;
+    }
+
+    const auto lit = static_cast<AigLiteral>(aig->node_count() << 1);
+    aig->ands.emplace_back(a, b);
+    strash.emplace(key, lit);
+    return lit;
+  }
+
+  auto lor(AigLiteral a, AigLiteral b) -> AigLiteral
+  {
+    return invert(land(invert(a), invert(b)));
+  }
+
+  auto nand(AigLiteral a, AigLiteral b) -> AigLiteral
+  {
+    return invert(land(a, b));
+  }
+
+  auto lxor(AigLiteral a, AigLiteral b) -> AigLiteral
+  {
+    return lor(land(a, invert(b)), land(invert(a), b));
+  }
+
+  auto lnot(AigLiteral a) -> AigLiteral
+  {
+    return invert(a);
+  }
+
+  auto constant(bool on) -> AigLiteral
+  {
+    return on ? AIG_TRUE : AIG_FALSE;
+  }
+
+  /**
+   * sel ? b : a
+   */
+  auto mux(AigLiteral sel, AigLiteral a, AigLiteral b) -> AigLiteral
+  {
+    if (a == b) return a;
+    return lor(land(invert(sel), a), land(sel, b));
+  }
+
+  /**
+   * Output o of a truth table whose inputs are the given literals, as a tree of muxes.
+   */
+  auto table(const TruthTable& table, const std::vector<AigLiteral>& selects, std::size_t o) -> AigLiteral
+  {
+    const auto shift = table.output_count() - 1 - o;
+
+    // Leaves are the rows, every level up selects on the next more significant input.
+    level.resize(table.rows());
+    for (std::size_t row = 0; row < table.rows(); row++)
+    {
+      level[row] = ((table[row] >> shift) & 1) ? AIG_TRUE : AIG_FALSE;
+    }
+
+    for (std::size_t i = selects.size(); i-- > 0;)
+    {
+      for (std::size_t n = 0; n < level.size() / 2; n++)
+      {
+        level[n] = mux(selects[i], level[2 * n], level[2 * n + 1]);
+      }
+      level.resize(level.size() / 2);
+    }
+
+    return level[0];
+  }
+
+  auto and_count() const -> std::size_t
+  {
+    return aig->ands.size();
+  }
+
+  auto add_output(AigLiteral lit) -> void
+  {
+    aig->outputs.push_back(lit);
+  }
+
+  auto finish() -> std::shared_ptr<const Aig>
+  {
+    return std::move(aig);
+  }
+
+private:
+  std::shared_ptr<Aig>                         aig;
+  std::unordered_map<std::uint64_t, AigLiteral> strash{};
+  std::vector<AigLiteral>                      level{};
+};
+
+/**
+ * Translate a netlist into an Aig. Truth table cells are expanded into a tree of
+ * muxes over their inputs (which structural hashing mostly collapses again).
+ *
+ * Returns nullptr if the netlist holds state (sequential cells, feedback loops,
+ * builtins other than the word-level primitives) or the graph grows past AIG_AND_LIMIT.
+ */
+inline auto build_aig(const Netlist& netlist) -> std::shared_ptr<const Aig>
+{
+  if (netlist.has_sequential() || netlist.has_feedback())
+  {
+    return nullptr;
+  }
+
+  AigBuilder builder{ netlist.input_count };
+
+  std::vector<AigLiteral> nets(netlist.net_count, AIG_FALSE);
+  for (std::size_t i = 0; i < netlist.input_count; i++)
+  {
+    nets[i] = builder.input(i);
+  }
+
+  std::vector<AigLiteral> selects{};
+  for (const auto& cell : netlist.cells)
+  {
+    const auto in = [&](std::size_t n) { return nets[netlist.input_of(cell, n)]; };
+
+    switch (cell.type)
+    {
+      case CellType::NAND:
+      {
+        nets[netlist.output_of(cell, 0)] = builder.nand(in(0), in(1));
+        break;
+      }
+      case CellType::TABLE:
+      {
+        selects.resize(cell.input_count);
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          selects[i] = in(i);
+        }
+
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          nets[netlist.output_of(cell, o)] = builder.table(*netlist.tables[cell.payload], selects, o);
+        }
+        break;
+      }
+      case CellType::BUILTIN:
+      {
+        const auto word = builtin::word_op(*netlist.builtins[cell.payload]);
+        if (word == builtin::WordOp::NONE)
+        {
+          return nullptr;
+        }
+
+        AigLiteral ins[builtin::WORD_MAX_INPUTS];
+        AigLiteral outs[builtin::WORD_MAX_OUTPUTS];
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          ins[i] = in(i);
+        }
+
+        builtin::word_lower(word, ins, outs, builder);
+
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          nets[netlist.output_of(cell, o)] = outs[o];
+        }
+        break;
+      }
+      case CellType::DFF:
+      {
+        return nullptr;
+      }
+    }
+
+    if (builder.and_count() > AIG_AND_LIMIT)
+    {
+      return nullptr;
+    }
+  }
+
+  for (auto net : netlist.output_nets)
+  {
+    builder.add_output(nets[net]);
+  }
+
+  return builder.finish();
+}
+
+/**
+ * Translate a truth table into an Aig, see AigBuilder::table.
+ */
+inline auto build_aig(const TruthTable& table) -> std::shared_ptr<const Aig>
+{
+  const auto input_count = table.input_count();
+  AigBuilder builder{ input_count };
+
+  std::vector<AigLiteral> selects(input_count);
+  for (std::size_t i = 0; i < input_count; i++)
+  {
+    selects[i] = builder.input(i);
+  }
+
+  for (std::size_t o = 0; o < table.output_count(); o++)
+  {
+    builder.add_output(builder.table(table, selects, o));
+  }
+
+  return builder.finish();
+}
+
+/**
+ * Translate a word-level primitive into an Aig, see builtin::word_lower.
+ */
+inline auto build_aig(builtin::WordOp word) -> std::shared_ptr<const Aig>
+{
+  const auto input_count = builtin::word_inputs(word);
+  AigBuilder builder{ input_count };
+
+  AigLiteral ins[builtin::WORD_MAX_INPUTS];
+  AigLiteral outs[builtin::WORD_MAX_OUTPUTS];
+  for (std::size_t i = 0; i < input_count; i++)
+  {
+    ins[i] = builder.input(i);
+  }
+
+  builtin::word_lower(word, ins, outs, builder);
+
+  for (std::size_t o = 0; o < builtin::word_outputs(word); o++)
+  {
+    builder.add_output(outs[o]);
+  }
+
+  return builder.finish();
+}
+
+struct EquivalenceResult
+{
+  bool              equivalent{ true };
+  bool              exhaustive{};      // Every input combination was compared.
+  std::size_t       vectors{};         // Number of input vectors compared.
+  std::vector<bool> counterexample{};  // Inputs on which the chips differ, by input index.
+};
+
+/**
+ * Compare two graphs with the same number of inputs and outputs by simulation,
+ * 64 vectors at a time. Narrow graphs are compared on every input combination
+ * (row r sets input i to bit input_count - 1 - i of r, like the truth tables),
+ * wider ones on EQUIVALENCE_RANDOM_BATCHES batches of random vectors, in which
+ * case "equivalent" only means that no difference was found.
+ */
+inline auto check_equivalence(const Aig& a, const Aig& b) -> EquivalenceResult
+{
+  const auto input_count = a.input_count;
+  const auto output_count = a.outputs.size();
+
+  EquivalenceResult result{};
+  result.exhaustive = input_count <= EQUIVALENCE_EXHAUSTIVE_LIMIT;
+
+  std::vector<std::uint64_t> inputs(input_count);
+  std::vector<std::uint64_t> nodes(std::max(a.node_count(), b.node_count()));
+  std::vector<std::uint64_t> results_a(output_count);
+  std::vector<std::uint64_t> results_b(output_count);
+
+  const std::uint64_t rows = result.exhaustive ? (std::uint64_t{ 1 } << input_count) : EQUIVALENCE_RANDOM_BATCHES * 64;
+  std::mt19937_64 random{ 0x5eed };
+
+  for (std::uint64_t base = 0; base < rows; base += 64)
+  {
+    const auto lanes = std::min<std::uint64_t>(64, rows - base);
+
+    if (result.exhaustive)
+    {
+      std::fill(inputs.begin(), inputs.end(), 0);
+      for (std::uint64_t lane = 0; lane < lanes; lane++)
+      {
+        for (std::size_t i = 0; i < input_count; i++)
+        {
+          inputs[i] |= (((base + lane) >> (input_count - 1 - i)) & 1) << lane;
+        }
+      }
+    }
+    else
+    {
+      for (auto& word : inputs) word = random();
+    }
+
+    a.evaluate(inputs.data(), nodes.data(), results_a.data());
+    b.evaluate(inputs.data(), nodes.data(), results_b.data());
+
+    const auto lane_mask = (lanes == 64) ? ~std::uint64_t{} : ((std::uint64_t{ 1 } << lanes) - 1);
+    std::uint64_t diff{};
+    for (std::size_t o = 0; o < output_count; o++)
+    {
+      diff |= (results_a[o] ^ results_b[o]) & lane_mask;
+    }
+
+    if (diff != 0)
+    {
+      const auto lane = std::countr_zero(diff);
+      result.equivalent = false;
+      result.vectors += static_cast<std::size_t>(lane) + 1;
+      result.counterexample.resize(input_count);
+      for (std::size_t i = 0; i < input_count; i++)
+      {
+        result.counterexample[i] = (inputs[i] >> lane) & 1;
+      }
+      return result;
+    }
+
+    result.vectors += lanes;
+  }
+
+  return result;
+}
+
+enum class Proof
+{
+  EQUIVALENT,
+  DIFFERENT,
+  UNKNOWN,   // The decision diagrams outgrew BDD_NODE_LIMIT.
+};
+
+/**
+ * Reduced ordered binary decision diagrams, the inputs being tested in a fixed
+ * order. A function has exactly one diagram, so two functions are equal if and
+ * only if they end up on the same node. Nodes 0 and 1 are false and true.
+ */
+class Bdd
+{
+public:
+  static constexpr std::uint32_t FALSE{ 0 };
+  static constexpr std::uint32_t TRUE{ 1 };
+
+  explicit Bdd(std::size_t variable_count)
+  : nodes{ { static_cast<std::uint32_t>(variable_count), FALSE, FALSE }, { static_cast<std::uint32_t>(variable_count), TRUE, TRUE } }
+  {
+  }
+
+  /**
+   * The variable tested at the given position of the order.
+   */
+  auto variable(std::size_t level) -> std::uint32_t
+  {
+    return make(static_cast<std::uint32_t>(level), FALSE, TRUE);
+  }
+
+  auto land(std::uint32_t f, std::uint32_t g) -> std::uint32_t
+  {
+    if (f == FALSE || g == FALSE || overflow) return FALSE;
+    if (f == TRUE || f == g) return g;
+    if (g == TRUE) return f;
+    if (f > g) std::swap(f, g);
+
+    const auto key = (std::uint64_t{ f } << 32) | g;
+    if (const auto it = and_cache.find(key); it != and_cache.end()) return it->second;
+
+    const auto level = std::min(nodes[f].level, nodes[g].level);
+    const auto [f0, f1] = cofactors(f, level);
+    const auto [g0, g1] = cofactors(g, level);
+    const auto lo = land(f0, g0);
+    const auto hi = land(f1, g1);
+    const auto result = make(level, lo, hi);
+
+    and_cache.emplace(key, result);
+    return result;
+  }
+
+  auto lnot(std::uint32_t f) -> std::uint32_t
+  {
+    if (f <= TRUE || overflow) return f ^ 1;
+
+    if (const auto it = not_cache.find(f); it != not_cache.end()) return it->second;
+
+    const auto node = nodes[f];
+    const auto lo = lnot(node.lo);
+    const auto hi = lnot(node.hi);
+    const auto result = make(node.level, lo, hi);
+
+    not_cache.emplace(f, result);
+    return result;
+  }
+
+  /**
+   * Whether BDD_NODE_LIMIT was hit, every result since is meaningless.
+   */
+  auto overflowed() const -> bool
+  {
+    return overflow;
+  }
+
+private:
+  struct Node
+  {
+    std::uint32_t level;
+    std::uint32_t lo;
+    std::uint32_t hi;
+  };
+
+  auto cofactors(std::uint32_t f, std::uint32_t level) const -> std::pair<std::uint32_t, std::uint32_t>
+  {
+    return (nodes[f].level == level) ? std::pair{ nodes[f].lo, nodes[f].hi } : std::pair{ f, f };
+  }
+
+  auto make(std::uint32_t level, std::uint32_t lo, std::uint32_t hi) -> std::uint32_t
+  {
+    if (lo == hi) return lo;
+
+    // Levels fit in 6 bits and node indices in 29 (see BDD_NODE_LIMIT).
+    const auto key = (std::uint64_t{ level } << 58) | (std::uint64_t{ lo } << 29) | hi;
+    if (const auto it = unique.find(key); it != unique.end()) return it->second;
+
+    if (nodes.size() >= BDD_NODE_LIMIT)
+    {
+      overflow = true;
+      return FALSE;
+    }
+
+    const auto index = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back({ level, lo, hi });
+    unique.emplace(key, index);
+    return index;
+  }
+
+  std::vector<Node>                               nodes;
+  std::unordered_map<std::uint64_t, std::uint32_t> unique{};
+  std::unordered_map<std::uint64_t, std::uint32_t> and_cache{};
+  std::unordered_map<std::uint32_t, std::uint32_t> not_cache{};
+  bool                                            overflow{};
+};
+
+/**
+ * Prove two graphs with the same number of inputs and outputs equivalent (or
+ * not) on every input, by building the decision diagram of each output. order
+ * lists input indices, the ones which decide the most first; a bad order only
+ * costs nodes, up to UNKNOWN once BDD_NODE_LIMIT is reached.
+ */
+inline auto prove_equivalence(const Aig& a, const Aig& b, const std::vector<std::size_t>& order) -> Proof
+{
+  if (a.input_count != b.input_count || a.outputs.size() != b.outputs.size() || order.size() != a.input_count || a.input_count >= 64)
+  {
+    return Proof::UNKNOWN;
+  }
+
+  Bdd bdd{ a.input_count };
+
+  std::vector<std::uint32_t> variables(a.input_count);
+  for (std::size_t level = 0; level < order.size(); level++)
+  {
+    variables[order[level]] = bdd.variable(level);
+  }
+
+  const auto build = [&](const Aig& graph) -> std::vector<std::uint32_t> {
+    std::vector<std::uint32_t> diagrams(graph.node_count(), Bdd::FALSE);
+    std::copy(variables.begin(), variables.end(), diagrams.begin() + 1);
+
+    const auto literal = [&](AigLiteral lit) {
+      const auto node = diagrams[lit >> 1];
+      return (lit & 1) ? bdd.lnot(node) : node;
+    };
+
+    auto index = 1 + graph.input_count;
+    for (const auto& [x, y] : graph.ands)
+    {
+      diagrams[index++] = bdd.land(literal(x), literal(y));
+      if (bdd.overflowed()) return {};
+    }
+
+    std::vector<std::uint32_t> outputs{};
+    for (auto lit : graph.outputs)
+    {
+      outputs.push_back(literal(lit));
+    }
+    return outputs;
+  };
+
+  const auto outputs_a = build(a);
+  const auto outputs_b = build(b);
+
+  if (bdd.overflowed())
+  {
+    return Proof::UNKNOWN;
+  }
+
+  return (outputs_a == outputs_b) ? Proof::EQUIVALENT : Proof::DIFFERENT;
+}
+
+} /* namespace netlist */
+
+#endif /* NETLIST_AIG_H */
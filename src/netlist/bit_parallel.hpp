@@ -0,0 +1,410 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_BIT_PARALLEL_H
+#define NETLIST_BIT_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../gate.hpp"
+#include "../builtin/registry.hpp"
+#include "kernel.hpp"
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * Number of independent input vectors evaluated per pass.
+ */
+constexpr std::size_t LANE_COUNT{ 64 };
+
+using Lanes = std::uint64_t;
+
+/**
+ * Runs 64 copies of a flattened chip side by side. Every net holds one bit per
+ * copy (lane), so a NAND cell becomes a single ~(a & b) on 64-bit words.
+ *
+ * Only cells which can be expressed on words are supported: nand, dff, truth
+ * tables and the word-level primitives. The remaining builtins keep their state
+ * in a private instance, check supports() before constructing a simulator.
+ *
+ * The levelized part of the netlist runs through the gate kernel (see kernel.hpp),
+ * the remaining cells of each level are evaluated one by one.
+ */
+class BitParallelSimulator
+{
+public:
+  explicit BitParallelSimulator(const Netlist& netlist)
+  : netlist(netlist)
+  , nets(netlist.net_count, 0)
+  , gates(netlist)
+  , kernel(gate_kernel())
+  {
+  }
+
+  static auto supports(const Netlist& netlist) -> bool
+  {
+    for (const auto& cell : netlist.cells)
+    {
+      if (cell.type == CellType::BUILTIN && builtin::word_op(*netlist.builtins[cell.payload]) == builtin::WordOp::NONE)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto set_input(std::size_t index, Lanes lanes) -> void
+  {
+    nets[index] = lanes;
+  }
+
+  auto get_output(std::size_t index) const -> Lanes
+  {
+    return nets[netlist.output_nets[index]];
+  }
+
+  /**
+   * Same evaluation order as Interpreter::settle(), a lane is only stable once
+   * the feedback loops and sequential cells stop changing in every lane.
+   */
+  auto settle() -> bool
+  {
+    const auto& cells = netlist.cells;
+
+    for (std::size_t pass = 0; pass < SETTLE_LIMIT; pass++)
+    {
+      for (std::size_t level = 0; level < netlist.level_count(); level++)
+      {
+        kernel(gates, nets.data(), gates.gate_offsets[level], gates.gate_offsets[level + 1]);
+
+        for (auto r = gates.rest_offsets[level]; r < gates.rest_offsets[level + 1]; r++)
+        {
+          evaluate(cells[gates.rest_cells[r]]);
+        }
+      }
+
+      bool oscillating = false;
+      for (const auto& group : netlist.feedback_groups)
+      {
+        for (std::size_t loop = 0; ; loop++)
+        {
+          bool changed = false;
+          for (auto c = group.begin; c < group.end; c++)
+          {
+            changed |= evaluate(cells[c]);
+          }
+
+          if (!changed || !group.cyclic) break;
+          if (loop + 1 == SETTLE_LIMIT)
+          {
+            oscillating = true;
+            break;
+          }
+        }
+      }
+
+      bool unstable = false;
+      for (std::size_t c = netlist.sequential_begin; c < cells.size(); c++)
+      {
+        unstable |= evaluate(cells[c]);
+      }
+
+      if (!unstable)
+      {
+        return !oscillating;
+      }
+    }
+
+    return false;
+  }
+
+private:
+  auto write(NetId net, Lanes lanes) -> bool
+  {
+    const bool changed = nets[net] != lanes;
+    nets[net] = lanes;
+    return changed;
+  }
+
+  auto in(const Cell& cell, std::size_t n) const -> Lanes
+  {
+    return nets[netlist.input_of(cell, n)];
+  }
+
+  auto evaluate(const Cell& cell) -> bool
+  {
+    switch (cell.type)
+    {
+      case CellType::NAND:
+      {
+        return write(netlist.output_of(cell, 0), ~(in(cell, 0) & in(cell, 1)));
+      }
+      case CellType::DFF:
+      {
+        const auto clock = in(cell, 1);
+        const auto held = nets[netlist.output_of(cell, 0)];
+        return write(netlist.output_of(cell, 0), (clock & in(cell, 0)) | (~clock & held));
+      }
+      case CellType::TABLE:
+      {
+        const auto& table = *netlist.tables[cell.payload];
+
+        // Tables are indexed per lane, gather the rows first.
+        std::size_t rows[LANE_COUNT];
+        for (std::size_t lane = 0; lane < LANE_COUNT; lane++)
+        {
+          std::size_t index = 0;
+          for (std::size_t i = 0; i < cell.input_count; i++)
+          {
+            index = (index << 1) | ((in(cell, i) >> lane) & 1);
+          }
+          rows[lane] = table[index];
+        }
+
+        bool changed = false;
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          const auto shift = cell.output_count - 1 - o;
+
+          Lanes lanes = 0;
+          for (std::size_t lane = 0; lane < LANE_COUNT; lane++)
+          {
+            lanes |= static_cast<Lanes>((rows[lane] >> shift) & 1) << lane;
+          }
+          changed |= write(netlist.output_of(cell, o), lanes);
+        }
+        return changed;
+      }
+      case CellType::BUILTIN:
+      {
+        // A word-level primitive, one bit (of every lane) at a time.
+        Lanes ins[builtin::WORD_MAX_INPUTS];
+        Lanes outs[builtin::WORD_MAX_OUTPUTS];
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          ins[i] = in(cell, i);
+        }
+
+        LaneLogic logic{};
+        builtin::word_lower(builtin::word_op(*netlist.builtins[cell.payload]), ins, outs, logic);
+
+        bool changed = false;
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          changed |= write(netlist.output_of(cell, o), outs[o]);
+        }
+        return changed;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Logic of builtin::word_lower on lanes.
+   */
+  struct LaneLogic
+  {
+    static auto land(Lanes a, Lanes b) -> Lanes { return a & b; }
+    static auto lor(Lanes a, Lanes b) -> Lanes { return a | b; }
+    static auto lxor(Lanes a, Lanes b) -> Lanes { return a ^ b; }
+    static auto lnot(Lanes a) -> Lanes { return ~a; }
+    static auto mux(Lanes sel, Lanes a, Lanes b) -> Lanes { return (~sel & a) | (sel & b); }
+    static auto constant(bool on) -> Lanes { return on ? ~Lanes{ 0 } : 0; }
+  };
+
+  /**
+   * Members.
+   */
+  const Netlist&     netlist;
+  std::vector<Lanes> nets;
+  GateLevels         gates;
+  GateKernel         kernel;
+};
+
+/**
+ * Rows handed to a worker at a time, a multiple of LANE_COUNT so that no two
+ * workers ever write to the same word of the table.
+ */
+constexpr std::uint64_t TABULATE_CHUNK_ROWS{ 4096 };
+
+enum class TabulateResult
+{
+  DONE,
+  UNSUPPORTED, // The netlist holds state, feedback or cells the lanes can't express.
+  UNSETTLED,   // Some row never settled, the table is meaningless.
+  CANCELLED,
+};
+
+/**
+ * Fill rows [begin, end) of the table, begin being a multiple of LANE_COUNT.
+ * Returns false as soon as a batch of rows doesn't settle.
+ */
+inline auto tabulate_rows(BitParallelSimulator& simulator, const Netlist& netlist, TruthTable& table, std::uint64_t begin, std::uint64_t end) -> bool
+{
+  // Lane L of input bit B (counted from the least significant end of the row index).
+  constexpr Lanes LOW_BIT_PATTERNS[] = {
+    0xAAAAAAAAAAAAAAAAULL,
+    0xCCCCCCCCCCCCCCCCULL,
+    0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL,
+    0xFFFF0000FFFF0000ULL,
+    0xFFFFFFFF00000000ULL,
+  };
+
+  const auto input_count = netlist.input_count;
+  const auto output_count = netlist.output_nets.size();
+
+  for (std::uint64_t base = begin; base < end; base += LANE_COUNT)
+  {
+    for (std::size_t pin = 0; pin < input_count; pin++)
+    {
+      const auto bit = input_count - 1 - pin;
+      const auto lanes = bit < 6
+                       ? LOW_BIT_PATTERNS[bit]
+                       : (((base >> bit) & 1) ? ~Lanes{ 0 } : Lanes{ 0 });
+      simulator.set_input(pin, lanes);
+    }
+
+    if (!simulator.settle())
+    {
+      return false;
+    }
+
+    const auto lanes_used = std::min<std::uint64_t>(LANE_COUNT, end - base);
+
+    std::size_t values[LANE_COUNT]{};
+    for (std::size_t o = 0; o < output_count; o++)
+    {
+      const auto lanes = simulator.get_output(o);
+      const auto shift = output_count - 1 - o;
+
+      for (std::uint64_t lane = 0; lane < lanes_used; lane++)
+      {
+        values[lane] |= static_cast<std::size_t>((lanes >> lane) & 1) << shift;
+      }
+    }
+
+    for (std::uint64_t lane = 0; lane < lanes_used; lane++)
+    {
+      table.set(base + lane, values[lane]);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Build the truth table of a purely combinational netlist, LANE_COUNT rows per pass.
+ * The table is sized for the netlist's inputs and outputs.
+ *
+ * Large tables are split into chunks of TABULATE_CHUNK_ROWS rows shared out between
+ * worker threads, each running its own simulator over the (read only) netlist. The
+ * calling thread works on chunks as well and reports the progress in between.
+ */
+inline auto tabulate(const Netlist& netlist, TruthTable& table, const SerializeOptions& options = {}) -> TabulateResult
+{
+  // A row of a chip with feedback may depend on the rows before it (a latch), which
+  // the lanes don't carry over. Those go through Gate::serialize's walk instead.
+  if (netlist.has_sequential() || netlist.has_feedback() || !BitParallelSimulator::supports(netlist))
+  {
+    return TabulateResult::UNSUPPORTED;
+  }
+
+  table = TruthTable(netlist.input_count, netlist.output_nets.size());
+
+  const std::uint64_t rows = table.rows();
+  const std::uint64_t chunks = (rows + TABULATE_CHUNK_ROWS - 1) / TABULATE_CHUNK_ROWS;
+
+  std::size_t thread_count = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+  thread_count = std::clamp<std::size_t>(thread_count, 1, chunks);
+
+  std::atomic<std::uint64_t> next_chunk{ 0 };
+  std::atomic<std::uint64_t> rows_done{ 0 };
+  std::atomic<bool>          unsettled{ false };
+
+  auto work = [&](bool report)
+  {
+    BitParallelSimulator simulator{ netlist };
+
+    for (auto chunk = next_chunk++; chunk < chunks && !options.cancelled() && !unsettled; chunk = next_chunk++)
+    {
+      const auto begin = chunk * TABULATE_CHUNK_ROWS;
+      const auto end = std::min(rows, begin + TABULATE_CHUNK_ROWS);
+
+      if (!tabulate_rows(simulator, netlist, table, begin, end))
+      {
+        unsettled = true;
+        return;
+      }
+      rows_done += end - begin;
+
+      if (report && options.progress)
+      {
+        options.progress(rows_done.load(), rows);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers{};
+  for (std::size_t t = 1; t < thread_count; t++)
+  {
+    workers.emplace_back(work, false);
+  }
+
+  work(true);
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  if (unsettled)
+  {
+    return TabulateResult::UNSETTLED;
+  }
+
+  if (options.cancelled())
+  {
+    return TabulateResult::CANCELLED;
+  }
+
+  if (options.progress)
+  {
+    options.progress(rows, rows);
+  }
+
+  return TabulateResult::DONE;
+}
+
+} /* namespace netlist */
+
+#endif /* NETLIST_BIT_PARALLEL_H */
@@ -0,0 +1,635 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_BYTECODE_H
+#define NETLIST_BYTECODE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../gate.hpp"
+#include "../builtin/registry.hpp"
+#include "netlist.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BYTECODE_COMPUTED_GOTO
+#endif
+
+namespace netlist
+{
+
+/**
+ * Instructions of a Program. Every instruction is an opcode followed by its
+ * operands, all of them 32 bit words:
+ *
+ *   NAND    dst a b
+ *   NOT     dst a                       (nand with both inputs tied)
+ *   DFF     dst d clock
+ *   WORD    op in[inputs] dst[outputs]  (word-level primitive, see builtin::WordOp)
+ *   LUT     table inputs outputs in[inputs] dst[outputs]
+ *   BUILTIN index last inputs outputs in[inputs] dst[outputs]
+ *   END
+ *
+ * A BUILTIN whose `last` isn't NO_LAST has memory, it is only evaluated once its
+ * inputs differ from the ones it saw last (kept at that offset).
+ */
+enum class Op : std::uint32_t
+{
+  NAND,
+  NOT,
+  DFF,
+  WORD,
+  LUT,
+  BUILTIN,
+  END,
+};
+
+constexpr std::uint32_t NO_LAST{ static_cast<std::uint32_t>(-1) };
+
+/**
+ * Levels costing at least this many instruction words are spread over the thread
+ * pool, in chunks of about PARALLEL_CHUNK_COST words. Anything smaller is over
+ * before the other threads would even have woken up.
+ */
+constexpr std::size_t PARALLEL_LEVEL_COST{ 1 << 14 };
+constexpr std::size_t PARALLEL_CHUNK_COST{ 1 << 12 };
+
+/**
+ * A netlist compiled into blocks of instructions, each one terminated by END:
+ * the level cells (in chunks, see Stage), the feedback cells (one block per
+ * FeedbackGroup) and the sequential cells. Shared by every instance of the chip.
+ */
+struct Program
+{
+  /**
+   * Chunks of the level block run in order of their stage. A stage is either one
+   * chunk holding any number of consecutive levels, or a single wide level cut
+   * into chunks which can run side by side (its cells don't read each other).
+   */
+  struct Stage
+  {
+    std::uint32_t first; // Index into chunks.
+    std::uint32_t count;
+  };
+
+  struct FeedbackBlock
+  {
+    std::uint32_t offset;
+    bool          cyclic;  // Run until it stops changing, see FeedbackGroup.
+  };
+
+  std::shared_ptr<const Netlist> netlist;
+  std::vector<std::uint32_t>     code{};
+  std::vector<std::uint32_t>     chunks{};     // Offsets of the level block's chunks.
+  std::vector<Stage>             stages{};
+  std::vector<FeedbackBlock>     feedback{};
+  std::uint32_t                  sequential{}; // Offset of the sequential block.
+  std::uint32_t                  last_size{};  // Memory needed for the builtins' last inputs.
+
+  explicit Program(std::shared_ptr<const Netlist> source)
+  : netlist(std::move(source))
+  {
+    emit_levels();
+    for (const auto& group : netlist->feedback_groups)
+    {
+      feedback.push_back({ static_cast<std::uint32_t>(code.size()), group.cyclic });
+      emit_block(group.begin, group.end);
+    }
+    sequential = static_cast<std::uint32_t>(code.size());
+    emit_block(netlist->sequential_begin, static_cast<std::uint32_t>(netlist->cells.size()));
+  }
+
+  /**
+   * Whether any level is wide enough to be evaluated in parallel.
+   */
+  auto is_parallel() const -> bool
+  {
+    return std::any_of(stages.begin(), stages.end(), [](const auto& stage) { return stage.count > 1; });
+  }
+
+private:
+  auto op(Op o) -> void
+  {
+    code.push_back(static_cast<std::uint32_t>(o));
+  }
+
+  /**
+   * Number of words emit() produces for the cell.
+   */
+  auto cost(const Cell& cell) const -> std::size_t
+  {
+    switch (cell.type)
+    {
+      case CellType::NAND: return 4;
+      case CellType::DFF: return 4;
+      case CellType::TABLE: return 4 + cell.input_count + cell.output_count;
+      case CellType::BUILTIN:
+      {
+        const auto word = builtin::word_op(*netlist->builtins[cell.payload]);
+        return (word != builtin::WordOp::NONE ? 2 : 5) + cell.input_count + cell.output_count;
+      }
+    }
+    return 0;
+  }
+
+  auto emit_levels() -> void
+  {
+    bool open = false;
+
+    const auto close = [&] {
+      if (!open) return;
+      op(Op::END);
+      stages.push_back({ static_cast<std::uint32_t>(chunks.size() - 1), 1 });
+      open = false;
+    };
+
+    for (std::size_t level = 0; level < netlist->level_count(); level++)
+    {
+      const auto begin = netlist->level_offsets[level];
+      const auto end = netlist->level_offsets[level + 1];
+
+      std::size_t level_cost = 0;
+      for (auto c = begin; c < end; c++)
+      {
+        level_cost += cost(netlist->cells[c]);
+      }
+
+      if (level_cost < PARALLEL_LEVEL_COST)
+      {
+        if (!open)
+        {
+          chunks.push_back(static_cast<std::uint32_t>(code.size()));
+          open = true;
+        }
+
+        for (auto c = begin; c < end; c++)
+        {
+          emit(netlist->cells[c]);
+        }
+        continue;
+      }
+
+      close();
+
+      const auto first = static_cast<std::uint32_t>(chunks.size());
+      std::size_t chunk_cost = PARALLEL_CHUNK_COST;
+
+      for (auto c = begin; c < end; c++)
+      {
+        if (chunk_cost >= PARALLEL_CHUNK_COST)
+        {
+          if (c != begin) op(Op::END);
+          chunks.push_back(static_cast<std::uint32_t>(code.size()));
+          chunk_cost = 0;
+        }
+
+        emit(netlist->cells[c]);
+        chunk_cost += cost(netlist->cells[c]);
+      }
+
+      op(Op::END);
+      stages.push_back({ first, static_cast<std::uint32_t>(chunks.size()) - first });
+    }
+
+    close();
+  }
+
+  auto emit_block(std::uint32_t begin, std::uint32_t end) -> void
+  {
+    for (auto c = begin; c < end; c++)
+    {
+      emit(netlist->cells[c]);
+    }
+    op(Op::END);
+  }
+
+  auto emit(const Cell& cell) -> void
+  {
+    const auto in = [&](std::size_t i) { return netlist->input_of(cell, i); };
+    const auto out = [&](std::size_t o) { return netlist->output_of(cell, o); };
+
+    switch (cell.type)
+    {
+      case CellType::NAND:
+      {
+        if (in(0) == in(1))
+        {
+          op(Op::NOT);
+          code.insert(code.end(), { out(0), in(0) });
+        }
+        else
+        {
+          op(Op::NAND);
+          code.insert(code.end(), { out(0), in(0), in(1) });
+        }
+        break;
+      }
+      case CellType::DFF:
+      {
+        op(Op::DFF);
+        code.insert(code.end(), { out(0), in(0), in(1) });
+        break;
+      }
+      case CellType::TABLE:
+      {
+        op(Op::LUT);
+        code.insert(code.end(), { cell.payload, cell.input_count, cell.output_count });
+        operands(cell);
+        break;
+      }
+      case CellType::BUILTIN:
+      {
+        if (const auto word = builtin::word_op(*netlist->builtins[cell.payload]); word != builtin::WordOp::NONE)
+        {
+          op(Op::WORD);
+          code.push_back(static_cast<std::uint32_t>(word));
+          operands(cell);
+          break;
+        }
+
+        op(Op::BUILTIN);
+        code.insert(code.end(), { cell.payload, cell.sequential ? last_size : NO_LAST, cell.input_count, cell.output_count });
+        operands(cell);
+
+        if (cell.sequential)
+        {
+          last_size += cell.input_count;
+        }
+        break;
+      }
+    }
+  }
+
+  auto operands(const Cell& cell) -> void
+  {
+    for (std::size_t i = 0; i < cell.input_count; i++) code.push_back(netlist->input_of(cell, i));
+    for (std::size_t o = 0; o < cell.output_count; o++) code.push_back(netlist->output_of(cell, o));
+  }
+};
+
+/**
+ * Per instance state of a chip running on a Program.
+ *
+ * Every cell is evaluated on every step, which for busy chips is cheaper than
+ * keeping track of the ones whose inputs changed (see EventSimulator for the
+ * others): the level block runs once, the feedback blocks in order (a loop until
+ * it stops changing) and the sequential block last, repeated for as long as a
+ * sequential output changed. Clock edges (see tick)
+ * bypass the blocks and go to the sequential cells directly.
+ */
+class Interpreter
+{
+public:
+  /**
+   * Wide levels are spread over the given pool, by default the shared one.
+   */
+  explicit Interpreter(std::shared_ptr<const Program> program, ThreadPool* thread_pool = nullptr)
+  : program(std::move(program))
+  , state(this->program->netlist->net_count + this->program->last_size, 0)
+  , nets(state.data())
+  , last(nets + this->program->netlist->net_count)
+  , pool(thread_pool)
+  {
+    builtins.reserve(this->program->netlist->builtins.size());
+    for (auto* prototype : this->program->netlist->builtins)
+    {
+      builtins.push_back(prototype->duplicate());
+    }
+
+    if (pool == nullptr && this->program->is_parallel())
+    {
+      pool = &ThreadPool::shared();
+    }
+
+    run_chunk = [this](std::size_t i) { run(this->program->code.data() + this->program->chunks[stage->first + i]); };
+  }
+
+  Interpreter(const Interpreter&) = delete;
+  auto operator=(const Interpreter&) -> Interpreter& = delete;
+
+  auto set_input(std::size_t index, bool on) -> void
+  {
+    nets[index] = on;
+  }
+
+  auto get_output(std::size_t index) const -> bool
+  {
+    return nets[program->netlist->output_nets[index]] != 0;
+  }
+
+  /**
+   * Returns false if the circuit did not settle: a feedback loop still changed after
+   * SETTLE_LIMIT runs, or the sequential cells after SETTLE_LIMIT passes.
+   */
+  auto settle() -> bool
+  {
+    const auto* code = program->code.data();
+
+    for (std::size_t pass = 0; pass < SETTLE_LIMIT; pass++)
+    {
+      run_levels();
+
+      bool oscillating = false;
+      for (const auto& block : program->feedback)
+      {
+        std::size_t loop = 0;
+        while (run(code + block.offset) && block.cyclic)
+        {
+          if (++loop == SETTLE_LIMIT)
+          {
+            oscillating = true;
+            break;
+          }
+        }
+      }
+
+      const bool changed = run(code + program->sequential);
+      initialised = true;
+
+      if (!changed)
+      {
+        return !oscillating;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Run clock cycles (see Gate::tick): settle, then clock every sequential cell at
+   * once and settle again, once per cycle. Returns false if the circuit failed to
+   * settle at any point.
+   */
+  auto tick(std::size_t cycles = 1) -> bool
+  {
+    bool settled = settle();
+
+    for (std::size_t cycle = 0; cycle < cycles; cycle++)
+    {
+      edge();
+      settled &= settle();
+    }
+
+    return settled;
+  }
+
+private:
+  /**
+   * Clock edge of every sequential cell, in two phases so that none of them sees
+   * another's output change before sampling its own inputs.
+   */
+  auto edge() -> void
+  {
+    const auto& netlist = *program->netlist;
+    const auto  begin = netlist.sequential_begin;
+    sampled.resize(netlist.cells.size() - begin);
+
+    for (auto c = begin; c < netlist.cells.size(); c++)
+    {
+      const auto& cell = netlist.cells[c];
+
+      if (cell.type == CellType::DFF)
+      {
+        sampled[c - begin] = nets[netlist.input_of(cell, 0)];
+      }
+      else if (cell.type == CellType::BUILTIN)
+      {
+        auto& gate = *builtins[cell.payload];
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          gate.input_pins[i].set(nets[netlist.input_of(cell, i)] != 0);
+        }
+        gate.sample();
+      }
+    }
+
+    for (auto c = begin; c < netlist.cells.size(); c++)
+    {
+      const auto& cell = netlist.cells[c];
+
+      if (cell.type == CellType::DFF)
+      {
+        nets[netlist.output_of(cell, 0)] = sampled[c - begin];
+      }
+      else if (cell.type == CellType::BUILTIN)
+      {
+        auto& gate = *builtins[cell.payload];
+        gate.commit();
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          nets[netlist.output_of(cell, o)] = gate.output_pins[o].is_active();
+        }
+      }
+    }
+  }
+
+  auto run_levels() -> void
+  {
+    for (const auto& current : program->stages)
+    {
+      stage = &current;
+
+      if (current.count > 1 && pool != nullptr)
+      {
+        pool->parallel_for(current.count, run_chunk);
+        continue;
+      }
+
+      for (std::size_t i = 0; i < current.count; i++)
+      {
+        run_chunk(i);
+      }
+    }
+  }
+
+  /**
+   * Execute one block, returns true if any net it writes changed.
+   */
+  auto run(const std::uint32_t* pc) -> bool
+  {
+    auto* n = nets;
+    bool changed = false;
+
+    const auto write = [&](std::uint32_t net, std::uint8_t value) {
+      changed |= n[net] != value;
+      n[net] = value;
+    };
+
+#ifdef BYTECODE_COMPUTED_GOTO
+    static const void* labels[] = { &&op_nand, &&op_not, &&op_dff, &&op_word, &&op_lut, &&op_builtin, &&op_end };
+#define DISPATCH() goto *labels[*pc++]
+#define CASE_OP(name, label) label:
+#else
+#define DISPATCH() continue
+#define CASE_OP(name, label) case Op::name:
+    while (true) switch (static_cast<Op>(*pc++))
+#endif
+    {
+#ifdef BYTECODE_COMPUTED_GOTO
+      DISPATCH();
+#endif
+
+      CASE_OP(NAND, op_nand)
+      {
+        write(pc[0], !(n[pc[1]] & n[pc[2]]));
+        pc += 3;
+        DISPATCH();
+      }
+
+      CASE_OP(NOT, op_not)
+      {
+        write(pc[0], !n[pc[1]]);
+        pc += 2;
+        DISPATCH();
+      }
+
+      CASE_OP(DFF, op_dff)
+      {
+        if (n[pc[2]]) write(pc[0], n[pc[1]]);
+        pc += 3;
+        DISPATCH();
+      }
+
+      CASE_OP(WORD, op_word)
+      {
+        // Gathered into a row, like a LUT, but computed instead of looked up.
+        const auto  word = static_cast<builtin::WordOp>(pc[0]);
+        const auto  inputs = builtin::word_inputs(word);
+        const auto  outputs = builtin::word_outputs(word);
+        const auto* in = pc + 1;
+        const auto* out = in + inputs;
+
+        std::uint64_t row = 0;
+        for (std::size_t i = 0; i < inputs; i++)
+        {
+          row = (row << 1) | n[in[i]];
+        }
+
+        const auto result = builtin::word_evaluate(word, row);
+        for (std::size_t o = 0; o < outputs; o++)
+        {
+          write(out[o], (result >> (outputs - 1 - o)) & 1);
+        }
+
+        pc = out + outputs;
+        DISPATCH();
+      }
+
+      CASE_OP(LUT, op_lut)
+      {
+        const auto& table = *program->netlist->tables[pc[0]];
+        const auto  inputs = pc[1];
+        const auto  outputs = pc[2];
+        const auto* in = pc + 3;
+        const auto* out = in + inputs;
+
+        std::size_t index = 0;
+        for (std::uint32_t i = 0; i < inputs; i++)
+        {
+          index = (index << 1) | n[in[i]];
+        }
+
+        const auto row = table[index];
+        for (std::uint32_t o = 0; o < outputs; o++)
+        {
+          write(out[o], (row >> (outputs - 1 - o)) & 1);
+        }
+
+        pc = out + outputs;
+        DISPATCH();
+      }
+
+      CASE_OP(BUILTIN, op_builtin)
+      {
+        const auto  index = pc[0];
+        const auto  offset = pc[1];
+        const auto  inputs = pc[2];
+        const auto  outputs = pc[3];
+        const auto* in = pc + 4;
+        const auto* out = in + inputs;
+        pc = out + outputs;
+
+        // Builtins with memory only run again once their inputs change.
+        if (offset != NO_LAST)
+        {
+          auto* seen = last + offset;
+          bool stale = !initialised;
+          for (std::uint32_t i = 0; i < inputs; i++)
+          {
+            stale |= seen[i] != n[in[i]];
+            seen[i] = n[in[i]];
+          }
+          if (!stale) DISPATCH();
+        }
+
+        auto& gate = *builtins[index];
+        for (std::uint32_t i = 0; i < inputs; i++)
+        {
+          gate.input_pins[i].set(n[in[i]] != 0);
+        }
+
+        gate.simulate();
+
+        for (std::uint32_t o = 0; o < outputs; o++)
+        {
+          write(out[o], gate.output_pins[o].is_active());
+        }
+        DISPATCH();
+      }
+
+      CASE_OP(END, op_end)
+      {
+        return changed;
+      }
+    }
+
+#undef DISPATCH
+#undef CASE_OP
+    return changed;
+  }
+
+  std::shared_ptr<const Program>     program;
+  std::vector<std::uint8_t>          state;  // Nets followed by the builtins' last inputs, one allocation per instance.
+  std::uint8_t*                      nets;
+  std::uint8_t*                      last;
+  std::vector<std::unique_ptr<Gate>> builtins{};
+  std::vector<std::uint8_t>          sampled{};  // Next state of the sequential cells during an edge.
+  bool                               initialised{ false };
+
+  /**
+   * Level stages, the chunks of a wide one run on the pool.
+   */
+  ThreadPool*                        pool;
+  const Program::Stage*              stage{ nullptr };
+  std::function<void(std::size_t)>   run_chunk{};
+};
+
+} /* namespace netlist */
+
+#endif /* NETLIST_BYTECODE_H */
@@ -0,0 +1,441 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_COMPILER_H
+#define NETLIST_COMPILER_H
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../gate.hpp"
+#include "../wire.hpp"
+#include "../builtin/registry.hpp"
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * Flattens a fully instantiated chip into a Netlist.
+ *
+ * The compiler walks the subgate tree of the given chip. Custom subgates are
+ * dissolved, everything else (nand, dff, serialized chips and builtins) becomes
+ * a cell. Subgates which are flattened already have their netlist spliced in.
+ * Every pin in between is resolved to the net of whatever drives it by
+ * following the wires backwards.
+ */
+class Compiler
+{
+public:
+  explicit Compiler(Gate& root)
+  : root(root)
+  {
+  }
+
+  /**
+   * Returns nullptr if the chip is already a primitive.
+   */
+  auto compile() -> std::shared_ptr<Netlist>
+  {
+    if (is_primitive(root))
+    {
+      return nullptr;
+    }
+
+    result = std::make_shared<Netlist>();
+    result->name = root.get_name();
+    result->input_count = root.input_pins.size();
+
+    for (std::size_t i = 0; i < root.input_pins.size(); i++)
+    {
+      net_of[&root.input_pins[i]] = static_cast<NetId>(i);
+    }
+
+    // Reserve the net which is tied low.
+    next_net = result->zero_net() + 1;
+
+    collect(root);
+
+    // All the wires are known now, so every cell input can be resolved.
+    for (auto& splice : splices)
+    {
+      for (auto& pin : splice.gate->input_pins)
+      {
+        splice.input_nets.push_back(resolve(&pin));
+      }
+    }
+
+    for (auto& pending : cells)
+    {
+      if (pending.gate == nullptr)
+      {
+        const auto& splice = splices[pending.splice];
+        for (auto& net : pending.inputs)
+        {
+          net = splice.map(net, result->zero_net());
+        }
+        continue;
+      }
+
+      for (auto& pin : pending.gate->input_pins)
+      {
+        pending.inputs.push_back(resolve(&pin));
+      }
+    }
+
+    for (auto& pin : root.output_pins)
+    {
+      result->output_nets.push_back(resolve(&pin));
+    }
+
+    result->net_count = next_net;
+
+    levelize();
+
+    return result;
+  }
+
+private:
+  /**
+   * A flattened subgate whose netlist is copied into ours. Its internal nets are
+   * moved up to start at `base`, its input nets become whatever drives its pins.
+   */
+  struct Splice
+  {
+    Gate*              gate;
+    const Netlist*     netlist;
+    NetId              base;
+    std::vector<NetId> input_nets;
+
+    auto map_internal(NetId net) const -> NetId
+    {
+      return base + net - static_cast<NetId>(netlist->input_count) - 1;
+    }
+
+    auto map(NetId net, NetId zero) const -> NetId
+    {
+      if (net < netlist->input_count) return input_nets[net];
+      if (net == netlist->zero_net()) return zero;
+      return map_internal(net);
+    }
+  };
+
+  struct PendingCell
+  {
+    Gate*              gate;       // The primitive subgate, null if the cell comes from a splice.
+    std::uint32_t      splice;
+    CellType           type;
+    bool               sequential;
+    std::uint32_t      payload;
+    std::vector<NetId> inputs;
+    std::vector<NetId> outputs;
+    std::uint32_t      level;
+  };
+
+  static auto is_primitive(const Gate& gate) -> bool
+  {
+    return gate.type != GateType::CUSTOM || gate.serialized;
+  }
+
+  static auto is_sequential(GateType type) -> bool
+  {
+    // Anything with a clock edge, serialized chips have none.
+    const auto* entry = builtin::find(type);
+    return entry != nullptr && entry->commit != nullptr;
+  }
+
+  auto collect(Gate& gate) -> void
+  {
+    for (const auto& wire : gate.design->wires)
+    {
+      driver[wire.output] = wire.input;
+    }
+
+    for (auto& subgate : gate.design->subgates)
+    {
+      if (is_primitive(*subgate))
+      {
+        add_cell(*subgate);
+      }
+      else if (subgate->flattened)
+      {
+        splice_netlist(*subgate);
+      }
+      else
+      {
+        collect(*subgate);
+      }
+    }
+  }
+
+  auto add_cell(Gate& gate) -> void
+  {
+    PendingCell cell{ &gate, 0, CellType::BUILTIN, is_sequential(gate.type), 0, {}, {}, 0 };
+
+    switch (gate.type)
+    {
+      break; case GateType::NAND: cell.type = CellType::NAND;
+      break; case GateType::DFF: cell.type = CellType::DFF;
+      break; case GateType::CUSTOM:
+      {
+        cell.type = CellType::TABLE;
+        cell.payload = static_cast<std::uint32_t>(result->tables.size());
+        result->tables.push_back(gate.serialized_computation_ptr);
+      }
+      break; default:
+      {
+        cell.payload = static_cast<std::uint32_t>(result->builtins.size());
+        result->builtins.push_back(&gate);
+      }
+    }
+
+    for (auto& pin : gate.output_pins)
+    {
+      net_of[&pin] = next_net;
+      cell.outputs.push_back(next_net++);
+    }
+
+    cells.push_back(std::move(cell));
+  }
+
+  auto splice_netlist(Gate& gate) -> void
+  {
+    const auto& flat = *gate.get_netlist();
+    const auto  index = static_cast<std::uint32_t>(splices.size());
+
+    splices.push_back({ &gate, &flat, next_net, {} });
+    const auto& splice = splices.back();
+
+    next_net += static_cast<NetId>(flat.net_count - flat.input_count - 1);
+
+    const auto table_offset = static_cast<std::uint32_t>(result->tables.size());
+    const auto builtin_offset = static_cast<std::uint32_t>(result->builtins.size());
+    result->tables.insert(result->tables.end(), flat.tables.begin(), flat.tables.end());
+    result->builtins.insert(result->builtins.end(), flat.builtins.begin(), flat.builtins.end());
+
+    for (const auto& cell : flat.cells)
+    {
+      PendingCell pending{ nullptr, index, cell.type, cell.sequential, cell.payload, {}, {}, 0 };
+
+      if (cell.type == CellType::TABLE) pending.payload += table_offset;
+      if (cell.type == CellType::BUILTIN) pending.payload += builtin_offset;
+
+      // Inputs are mapped once the splice's input pins have been resolved.
+      for (std::size_t i = 0; i < cell.input_count; i++)
+      {
+        pending.inputs.push_back(flat.input_of(cell, i));
+      }
+
+      for (std::size_t o = 0; o < cell.output_count; o++)
+      {
+        pending.outputs.push_back(splice.map_internal(flat.output_of(cell, o)));
+      }
+
+      cells.push_back(std::move(pending));
+    }
+
+    for (std::size_t o = 0; o < flat.output_nets.size(); o++)
+    {
+      const auto net = flat.output_nets[o];
+      auto*      pin = &gate.output_pins[o];
+
+      if (net < flat.input_count)
+      {
+        // Passed straight through from one of its inputs.
+        driver[pin] = &gate.input_pins[net];
+      }
+      else if (net != flat.zero_net())
+      {
+        net_of[pin] = splice.map_internal(net);
+      }
+    }
+  }
+
+  auto resolve(const Pin* pin) -> NetId
+  {
+    std::vector<const Pin*> chain{};
+    NetId net = result->zero_net();
+
+    while (true)
+    {
+      if (auto it = net_of.find(pin); it != net_of.end())
+      {
+        net = it->second;
+        break;
+      }
+
+      auto it = driver.find(pin);
+
+      // Undriven pins (or a loop made purely out of wires) never change.
+      if (it == driver.end() || chain.size() > driver.size())
+      {
+        break;
+      }
+
+      chain.push_back(pin);
+      pin = it->second;
+    }
+
+    for (const auto* p : chain)
+    {
+      net_of[p] = net;
+    }
+
+    return net;
+  }
+
+  /**
+   * Order the cells for evaluation. Sequential cell outputs act as sources,
+   * so only purely combinational loops are left over once every acyclic cell
+   * has been assigned a level.
+   */
+  auto levelize() -> void
+  {
+    constexpr auto NONE = static_cast<std::uint32_t>(-1);
+
+    std::vector<std::uint32_t> driving_cell(next_net, NONE);
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      for (auto net : cells[c].outputs)
+      {
+        driving_cell[net] = c;
+      }
+    }
+
+    std::vector<std::vector<std::uint32_t>> readers(cells.size());
+    std::vector<std::uint32_t>              pending_inputs(cells.size(), 0);
+
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      if (cells[c].sequential) continue;
+
+      for (auto net : cells[c].inputs)
+      {
+        const auto d = driving_cell[net];
+        if (d != NONE && !cells[d].sequential)
+        {
+          readers[d].push_back(c);
+          pending_inputs[c]++;
+        }
+      }
+    }
+
+    std::vector<std::uint32_t> ready{};
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      if (!cells[c].sequential && pending_inputs[c] == 0)
+      {
+        ready.push_back(c);
+      }
+    }
+
+    std::vector<bool> placed(cells.size(), false);
+    std::uint32_t     max_level = 0;
+
+    for (std::size_t i = 0; i < ready.size(); i++)
+    {
+      const auto c = ready[i];
+      placed[c] = true;
+      max_level = std::max(max_level, cells[c].level);
+
+      for (auto r : readers[c])
+      {
+        cells[r].level = std::max(cells[r].level, cells[c].level + 1);
+        if (--pending_inputs[r] == 0)
+        {
+          ready.push_back(r);
+        }
+      }
+    }
+
+    std::vector<std::uint32_t> order{ ready };
+    std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) { return cells[a].level < cells[b].level; });
+
+    result->level_offsets.assign(ready.empty() ? 0 : max_level + 2, 0);
+    for (auto c : ready)
+    {
+      result->level_offsets[cells[c].level + 1]++;
+    }
+    for (std::size_t l = 1; l < result->level_offsets.size(); l++)
+    {
+      result->level_offsets[l] += result->level_offsets[l - 1];
+    }
+
+    result->feedback_begin = static_cast<std::uint32_t>(order.size());
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      if (!cells[c].sequential && !placed[c])
+      {
+        order.push_back(c);
+      }
+    }
+
+    result->sequential_begin = static_cast<std::uint32_t>(order.size());
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      if (cells[c].sequential)
+      {
+        order.push_back(c);
+      }
+    }
+
+    for (auto c : order)
+    {
+      const auto& pending = cells[c];
+
+      result->cells.push_back({
+        pending.type,
+        pending.sequential,
+        static_cast<std::uint16_t>(pending.inputs.size()),
+        static_cast<std::uint16_t>(pending.outputs.size()),
+        static_cast<std::uint32_t>(result->pins.size()),
+        pending.payload
+      });
+
+      result->pins.insert(result->pins.end(), pending.inputs.begin(), pending.inputs.end());
+      result->pins.insert(result->pins.end(), pending.outputs.begin(), pending.outputs.end());
+    }
+
+    result->order_feedback();
+    result->build_fanout();
+  }
+
+  /**
+   * Members.
+   */
+  Gate&                                      root;
+  std::shared_ptr<Netlist>                   result{};
+  NetId                                      next_net{};
+  std::vector<PendingCell>                   cells{};
+  std::vector<Splice>                        splices{};
+  std::unordered_map<const Pin*, const Pin*> driver{};
+  std::unordered_map<const Pin*, NetId>      net_of{};
+};
+
+} /* namespace netlist */
+
+#endif /* NETLIST_COMPILER_H */
@@ -0,0 +1,323 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+#ifndef NETLIST_EVENT_H
+#define NETLIST_EVENT_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "../gate.hpp"
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * Per instance state of a chip running on the event-driven engine, selected per
+ * chip instead of the Interpreter (see Gate::set_event_driven).
+ *
+ * Writing a net queues the cells which read it (see Netlist::build_fanout), and
+ * only queued cells are evaluated. Combinational cells are popped in netlist order,
+ * so they only ever see their inputs in their final state, and a loop keeps going
+ * around for as long as its cells keep queueing each other. Queued sequential cells
+ * are evaluated as one batch once the combinational logic is stable.
+ *
+ * A step costs in proportion to what changed rather than to the size of the chip,
+ * which pays off on large chips where most of the logic sits idle from one step to
+ * the next (the memory of `computer`). On busy ones the Interpreter is faster.
+ */
+class EventSimulator
+{
+public:
+  explicit EventSimulator(std::shared_ptr<const Netlist> source)
+  : netlist(std::move(source))
+  , state(netlist->net_count + netlist->cells.size(), 0)
+  , nets(state.data())
+  , queued(nets + netlist->net_count)
+  , events(std::greater<std::uint32_t>{}, reserved<std::uint32_t>(netlist->cells.size()))
+  {
+    changed.reserve(netlist->net_count);
+    batch.reserve(netlist->cells.size() - netlist->sequential_begin);
+    sampled.resize(netlist->cells.size() - netlist->sequential_begin);
+
+    builtins.reserve(netlist->builtins.size());
+    for (auto* prototype : netlist->builtins)
+    {
+      builtins.push_back(prototype->duplicate());
+    }
+  }
+
+  EventSimulator(const EventSimulator&) = delete;
+  auto operator=(const EventSimulator&) -> EventSimulator& = delete;
+
+  auto set_input(std::size_t index, bool on) -> void
+  {
+    write(static_cast<NetId>(index), on);
+  }
+
+  auto get_output(std::size_t index) const -> bool
+  {
+    return nets[netlist->output_nets[index]] != 0;
+  }
+
+  /**
+   * Propagate every net which changed since the last settle. The first settle
+   * evaluates every cell once to bring the nets in line with the logic.
+   *
+   * Returns false if the circuit did not settle within SETTLE_LIMIT evaluations
+   * per cell. The events still pending are kept for the next settle, dropping them
+   * would leave the nets behind them stale.
+   */
+  auto settle() -> bool
+  {
+    if (!initialised)
+    {
+      initialised = true;
+      for (std::uint32_t c = 0; c < netlist->cells.size(); c++)
+      {
+        schedule(c);
+      }
+    }
+
+    std::size_t budget = SETTLE_LIMIT * netlist->cells.size();
+
+    while (true)
+    {
+      for (auto net : changed)
+      {
+        for (auto it = netlist->fanout_begin(net); it != netlist->fanout_end(net); it++)
+        {
+          schedule(*it);
+        }
+      }
+      changed.clear();
+
+      if (events.empty())
+      {
+        return true;
+      }
+
+      if (budget-- == 0)
+      {
+        return false;
+      }
+
+      if (events.top() < netlist->sequential_begin)
+      {
+        const auto c = events.top();
+        events.pop();
+        queued[c] = 0;
+
+        evaluate(netlist->cells[c]);
+        continue;
+      }
+
+      // Only sequential cells are left, they all sample the (now stable)
+      // combinational logic before any of their new outputs are propagated.
+      batch.clear();
+      while (!events.empty())
+      {
+        batch.push_back(events.top());
+        queued[events.top()] = 0;
+        events.pop();
+      }
+
+      for (auto c : batch)
+      {
+        evaluate(netlist->cells[c]);
+      }
+    }
+  }
+
+  /**
+   * Run clock cycles, see Interpreter::tick.
+   */
+  auto tick(std::size_t cycles = 1) -> bool
+  {
+    bool settled = settle();
+
+    for (std::size_t cycle = 0; cycle < cycles; cycle++)
+    {
+      edge();
+      settled &= settle();
+    }
+
+    return settled;
+  }
+
+private:
+  template <typename T>
+  static auto reserved(std::size_t capacity) -> std::vector<T>
+  {
+    std::vector<T> storage{};
+    storage.reserve(capacity);
+    return storage;
+  }
+
+  /**
+   * Clock edge of every sequential cell, sampled before any of them commits (see
+   * Interpreter::edge). Only the outputs which change queue anything.
+   */
+  auto edge() -> void
+  {
+    const auto begin = netlist->sequential_begin;
+
+    for (auto c = begin; c < netlist->cells.size(); c++)
+    {
+      const auto& cell = netlist->cells[c];
+
+      if (cell.type == CellType::DFF)
+      {
+        sampled[c - begin] = nets[netlist->input_of(cell, 0)];
+      }
+      else if (cell.type == CellType::BUILTIN)
+      {
+        auto& gate = *builtins[cell.payload];
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          gate.input_pins[i].set(nets[netlist->input_of(cell, i)] != 0);
+        }
+        gate.sample();
+      }
+    }
+
+    for (auto c = begin; c < netlist->cells.size(); c++)
+    {
+      const auto& cell = netlist->cells[c];
+
+      if (cell.type == CellType::DFF)
+      {
+        write(netlist->output_of(cell, 0), sampled[c - begin] != 0);
+      }
+      else if (cell.type == CellType::BUILTIN)
+      {
+        auto& gate = *builtins[cell.payload];
+        gate.commit();
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          write(netlist->output_of(cell, o), gate.output_pins[o].is_active());
+        }
+      }
+    }
+  }
+
+  auto schedule(std::uint32_t cell) -> void
+  {
+    if (!queued[cell])
+    {
+      queued[cell] = 1;
+      events.push(cell);
+    }
+  }
+
+  auto write(NetId net, bool on) -> void
+  {
+    const std::uint8_t value = on ? 1 : 0;
+
+    if (nets[net] != value)
+    {
+      nets[net] = value;
+      changed.push_back(net);
+    }
+  }
+
+  auto evaluate(const Cell& cell) -> void
+  {
+    switch (cell.type)
+    {
+      case CellType::NAND:
+      {
+        const bool a = nets[netlist->input_of(cell, 0)];
+        const bool b = nets[netlist->input_of(cell, 1)];
+        write(netlist->output_of(cell, 0), !(a && b));
+        break;
+      }
+      case CellType::DFF:
+      {
+        if (nets[netlist->input_of(cell, 1)])
+        {
+          write(netlist->output_of(cell, 0), nets[netlist->input_of(cell, 0)] != 0);
+        }
+        break;
+      }
+      case CellType::TABLE:
+      {
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          index = (index << 1) | nets[netlist->input_of(cell, i)];
+        }
+
+        const auto row = (*netlist->tables[cell.payload])[index];
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          write(netlist->output_of(cell, o), (row >> (cell.output_count - 1 - o)) & 1);
+        }
+        break;
+      }
+      case CellType::BUILTIN:
+      {
+        auto& gate = *builtins[cell.payload];
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          gate.input_pins[i].set(nets[netlist->input_of(cell, i)] != 0);
+        }
+
+        gate.simulate();
+
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          write(netlist->output_of(cell, o), gate.output_pins[o].is_active());
+        }
+        break;
+      }
+    }
+  }
+
+  std::shared_ptr<const Netlist>     netlist;
+  std::vector<std::uint8_t>          state;  // Nets followed by the queued flag of every cell, one allocation per instance.
+  std::uint8_t*                      nets;
+  std::uint8_t*                      queued;
+  std::vector<std::unique_ptr<Gate>> builtins{};
+
+  /**
+   * Nets written since the last propagation and the cells waiting to be evaluated,
+   * lowest position in the netlist first.
+   */
+  std::vector<NetId>                                                                      changed{};
+  std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, std::greater<std::uint32_t>> events;
+  std::vector<std::uint32_t>                                                              batch{};
+  std::vector<std::uint8_t>                                                               sampled{};  // Next state of the sequential cells during an edge.
+  bool                                                                                    initialised{ false };
+};
+
+} /* namespace netlist */
+
+#endif /* NETLIST_EVENT_H */
@@ -0,0 +1,263 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_KERNEL_H
+#define NETLIST_KERNEL_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NETLIST_KERNEL_X86
+#endif
+
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * The kernels below only run under BitParallelSimulator, that is when a chip is
+ * precomputed 64 rows at a time (see tabulate). The engines stepping a single
+ * instance (Interpreter, EventSimulator, native code) hold one bit per net, with
+ * nothing to fill a vector register with.
+ *
+ * Every cell with at most two inputs and a single output (nand, and the
+ * serialized not/and/or/xor...) is some function of (a, b). It is stored as
+ * the mask of each minterm, so the whole level runs the same branchless code:
+ *
+ *   out = (~a & ~b & m[0]) | (~a & b & m[1]) | (a & ~b & m[2]) | (a & b & m[3])
+ *
+ * One input cells use the same net for a and b.
+ */
+struct GateLevels
+{
+  std::vector<std::uint32_t> a{};
+  std::vector<std::uint32_t> b{};
+  std::vector<std::uint32_t> out{};
+  std::vector<std::uint64_t> minterms[4]{};
+
+  /**
+   * Gates of level L are [gate_offsets[L] .. gate_offsets[L + 1]), the other cells
+   * of the level (wider tables, builtins) are left in rest_cells.
+   */
+  std::vector<std::uint32_t> gate_offsets{};
+  std::vector<std::uint32_t> rest_offsets{};
+  std::vector<std::uint32_t> rest_cells{};
+
+  explicit GateLevels(const Netlist& netlist)
+  {
+    gate_offsets.push_back(0);
+    rest_offsets.push_back(0);
+
+    for (std::size_t level = 0; level < netlist.level_count(); level++)
+    {
+      for (auto c = netlist.level_offsets[level]; c < netlist.level_offsets[level + 1]; c++)
+      {
+        const auto& cell = netlist.cells[c];
+
+        if (!add_gate(netlist, cell))
+        {
+          rest_cells.push_back(c);
+        }
+      }
+
+      gate_offsets.push_back(static_cast<std::uint32_t>(out.size()));
+      rest_offsets.push_back(static_cast<std::uint32_t>(rest_cells.size()));
+    }
+  }
+
+private:
+  auto add_gate(const Netlist& netlist, const Cell& cell) -> bool
+  {
+    if (cell.output_count != 1 || cell.input_count == 0 || cell.input_count > 2)
+    {
+      return false;
+    }
+
+    // Truth of each minterm, indexed (a << 1) | b.
+    bool truth[4]{ true, true, true, false };
+
+    if (cell.type == CellType::TABLE)
+    {
+      const auto& table = *netlist.tables[cell.payload];
+      for (std::size_t m = 0; m < 4; m++)
+      {
+        // With a single input only the (0, 0) and (1, 1) minterms are reachable.
+        const auto index = cell.input_count == 2 ? m : (m >> 1);
+        truth[m] = (table[index] & 1) == 1;
+      }
+    }
+    else if (cell.type != CellType::NAND)
+    {
+      return false;
+    }
+
+    a.push_back(netlist.input_of(cell, 0));
+    b.push_back(netlist.input_of(cell, cell.input_count - 1));
+    out.push_back(netlist.output_of(cell, 0));
+    for (std::size_t m = 0; m < 4; m++)
+    {
+      minterms[m].push_back(truth[m] ? ~std::uint64_t{ 0 } : 0);
+    }
+    return true;
+  }
+};
+
+/**
+ * Evaluate gates [begin, end) of one level over 64-lane nets.
+ * Gates of the same level never read each other's outputs, so they can be evaluated in any order.
+ */
+inline auto evaluate_gates_scalar(const GateLevels& gates, std::uint64_t* nets, std::size_t begin, std::size_t end) -> void
+{
+  for (auto g = begin; g < end; g++)
+  {
+    const auto a = nets[gates.a[g]];
+    const auto b = nets[gates.b[g]];
+
+    nets[gates.out[g]] = (~a & ~b & gates.minterms[0][g])
+                       | (~a &  b & gates.minterms[1][g])
+                       | ( a & ~b & gates.minterms[2][g])
+                       | ( a &  b & gates.minterms[3][g]);
+  }
+}
+
+#ifdef NETLIST_KERNEL_X86
+__attribute__((target("avx2")))
+inline auto evaluate_gates_avx2(const GateLevels& gates, std::uint64_t* nets, std::size_t begin, std::size_t end) -> void
+{
+  const auto* base = reinterpret_cast<const long long*>(nets);
+  const auto ones = _mm256_set1_epi64x(-1);
+
+  auto g = begin;
+  for (; g + 4 <= end; g += 4)
+  {
+    const auto ia = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gates.a.data() + g));
+    const auto ib = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gates.b.data() + g));
+
+    // Net IDs are well below 2^31, a signed 32 bit gather index is fine.
+    const auto a = _mm256_i32gather_epi64(base, ia, 8);
+    const auto b = _mm256_i32gather_epi64(base, ib, 8);
+    const auto na = _mm256_xor_si256(a, ones);
+    const auto nb = _mm256_xor_si256(b, ones);
+
+    const auto m0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gates.minterms[0].data() + g));
+    const auto m1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gates.minterms[1].data() + g));
+    const auto m2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gates.minterms[2].data() + g));
+    const auto m3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gates.minterms[3].data() + g));
+
+    const auto result = _mm256_or_si256(
+      _mm256_or_si256(_mm256_and_si256(_mm256_and_si256(na, nb), m0), _mm256_and_si256(_mm256_and_si256(na, b), m1)),
+      _mm256_or_si256(_mm256_and_si256(_mm256_and_si256(a, nb), m2), _mm256_and_si256(_mm256_and_si256(a, b), m3)));
+
+    // No scatter in AVX2, write the four results back one by one.
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), result);
+    nets[gates.out[g + 0]] = lanes[0];
+    nets[gates.out[g + 1]] = lanes[1];
+    nets[gates.out[g + 2]] = lanes[2];
+    nets[gates.out[g + 3]] = lanes[3];
+  }
+
+  evaluate_gates_scalar(gates, nets, g, end);
+}
+#endif
+
+using GateKernel = void (*)(const GateLevels&, std::uint64_t*, std::size_t, std::size_t);
+
+inline auto has_avx2_kernel() -> bool
+{
+#ifdef NETLIST_KERNEL_X86
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+/**
+ * Pick the widest kernel the running CPU supports, checked once.
+ */
+inline auto gate_kernel() -> GateKernel
+{
+  static const GateKernel kernel = []() -> GateKernel
+  {
+#ifdef NETLIST_KERNEL_X86
+    if (has_avx2_kernel())
+    {
+      return evaluate_gates_avx2;
+    }
+#endif
+    return evaluate_gates_scalar;
+  }();
+
+  return kernel;
+}
+
+/**
+ * Run the gates of every level through both the scalar and the AVX2 kernel, each
+ * pass starting from the same random nets, and count the nets on which they end
+ * up differing. Always 0 without AVX2, there is only the scalar kernel then.
+ */
+inline auto compare_kernels(const Netlist& netlist, std::size_t passes, std::uint64_t seed = 1) -> std::size_t
+{
+  std::size_t mismatches = 0;
+
+#ifdef NETLIST_KERNEL_X86
+  if (!has_avx2_kernel()) return 0;
+
+  const GateLevels gates{ netlist };
+  std::mt19937_64 random{ seed };
+  std::vector<std::uint64_t> scalar(netlist.net_count);
+  std::vector<std::uint64_t> simd(netlist.net_count);
+
+  for (std::size_t pass = 0; pass < passes; pass++)
+  {
+    for (auto& net : scalar)
+    {
+      net = random();
+    }
+    simd = scalar;
+
+    for (std::size_t level = 0; level < netlist.level_count(); level++)
+    {
+      evaluate_gates_scalar(gates, scalar.data(), gates.gate_offsets[level], gates.gate_offsets[level + 1]);
+      evaluate_gates_avx2(gates, simd.data(), gates.gate_offsets[level], gates.gate_offsets[level + 1]);
+    }
+
+    for (std::size_t n = 0; n < netlist.net_count; n++)
+    {
+      mismatches += scalar[n] != simd[n];
+    }
+  }
+#endif
+
+  return mismatches;
+}
+
+} /* namespace netlist */
+
+#endif /* NETLIST_KERNEL_H */
@@ -0,0 +1,669 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_NATIVE_H
+#define NETLIST_NATIVE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NATIVE_DLOPEN
+#endif
+
+#include "../gate.hpp"
+#include "../builtin/registry.hpp"
+#include "../table_cache.hpp"
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * What the generated code gets to see of its simulator: the rows of every table
+ * cell and ways to evaluate and clock builtin cells, which stay regular Gates.
+ * Repeated verbatim at the top of every generated file.
+ */
+struct NativeHost
+{
+  const std::uint64_t* const* tables;
+  void*                       simulator;
+  void                      (*builtin)(void* simulator, std::uint32_t index, const std::uint8_t* in, std::uint8_t* out);
+  void                      (*sample)(void* simulator, std::uint32_t index, const std::uint8_t* in);
+  void                      (*commit)(void* simulator, std::uint32_t index, std::uint8_t* out);
+};
+
+/**
+ * Settles the chip, then for each of the given clock edges clocks every sequential
+ * cell and settles again (see Gate::tick). in/out hold one byte per pin, state is
+ * carried from one call to the next (see NativeLayout). Returns 0 if the chip did
+ * not settle.
+ */
+using NativeStep = int (*)(const NativeHost* host, const std::uint8_t* in, std::uint8_t* out, std::uint8_t* state, std::uint64_t edges);
+
+constexpr const char* NATIVE_SYMBOL{ "native_step" };
+
+constexpr const char* NATIVE_PREAMBLE{ R"(#include <cstdint>
+
+struct NativeHost
+{
+  const std::uint64_t* const* tables;
+  void*                       simulator;
+  void                      (*builtin)(void* simulator, std::uint32_t index, const std::uint8_t* in, std::uint8_t* out);
+  void                      (*sample)(void* simulator, std::uint32_t index, const std::uint8_t* in);
+  void                      (*commit)(void* simulator, std::uint32_t index, std::uint8_t* out);
+};
+
+static inline std::uint64_t lookup(const std::uint64_t* rows, std::uint64_t row, unsigned width)
+{
+  const std::uint64_t bit = row * width;
+  const std::uint64_t word = bit / 64;
+  const unsigned offset = bit % 64;
+
+  std::uint64_t value = rows[word] >> offset;
+  if (offset + width > 64)
+  {
+    value |= rows[word + 1] << (64 - offset);
+  }
+  return value;
+}
+)" };
+
+/**
+ * Where the state of a chip lives between two steps:
+ *  - byte 0 is set once every cell has been evaluated for the first time,
+ *  - then one byte per net driven by a feedback or sequential cell,
+ *  - then the last inputs seen by each builtin sequential cell, which (like in the
+ *    Interpreter) is only evaluated again once they change.
+ */
+struct NativeLayout
+{
+  std::vector<std::uint32_t> slot_of;        // Per net, 0 if the net isn't kept.
+  std::vector<std::uint32_t> inputs_of;      // Per cell, offset of the builtin's last inputs.
+  std::size_t                state_size{ 1 };
+
+  explicit NativeLayout(const Netlist& netlist)
+  : slot_of(netlist.net_count, 0)
+  , inputs_of(netlist.cells.size(), 0)
+  {
+    for (std::size_t c = netlist.feedback_begin; c < netlist.cells.size(); c++)
+    {
+      const auto& cell = netlist.cells[c];
+      for (std::size_t o = 0; o < cell.output_count; o++)
+      {
+        slot_of[netlist.output_of(cell, o)] = static_cast<std::uint32_t>(state_size++);
+      }
+    }
+
+    for (std::size_t c = netlist.sequential_begin; c < netlist.cells.size(); c++)
+    {
+      const auto& cell = netlist.cells[c];
+      if (cell.type == CellType::BUILTIN)
+      {
+        inputs_of[c] = static_cast<std::uint32_t>(state_size);
+        state_size += cell.input_count;
+      }
+    }
+  }
+};
+
+/**
+ * Straight-line C++ for a netlist, one function (NATIVE_SYMBOL) settling it.
+ *
+ * Every net is a local bool. Level cells are evaluated once in order, feedback loops
+ * are repeated until they stop changing and sequential cells are evaluated last,
+ * after which the whole thing repeats for as long as a sequential output changed.
+ * A clock edge samples the inputs of every sequential cell into locals before
+ * updating any of their outputs.
+ */
+inline auto emit_source(const Netlist& netlist) -> std::string
+{
+  const NativeLayout layout{ netlist };
+  std::ostringstream out{};
+
+  const auto net = [](NetId n) { return "n" + std::to_string(n); };
+
+  const auto emit_cell = [&](const Cell& cell, std::size_t c, const std::string& indent, bool track) {
+    const auto in = [&](std::size_t i) { return net(netlist.input_of(cell, i)); };
+    const auto assign = [&](std::size_t o, const std::string& value) {
+      const auto target = net(netlist.output_of(cell, o));
+      if (track) out << indent << "changed |= " << target << " != (" << value << ");\n";
+      out << indent << target << " = " << value << ";\n";
+    };
+
+    switch (cell.type)
+    {
+      case CellType::NAND:
+      {
+        assign(0, "!(" + in(0) + " && " + in(1) + ")");
+        break;
+      }
+      case CellType::DFF:
+      {
+        out << indent << "if (" << in(1) << ")\n" << indent << "{\n";
+        assign(0, in(0));
+        out << indent << "}\n";
+        break;
+      }
+      case CellType::TABLE:
+      {
+        out << indent << "{\n" << indent << "  const std::uint64_t row = lookup(host->tables[" << cell.payload << "], 0";
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          out << " | (std::uint64_t(" << in(i) << ") << " << (cell.input_count - 1 - i) << ")";
+        }
+        out << ", " << cell.output_count << ");\n";
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          assign(o, "((row >> " + std::to_string(cell.output_count - 1 - o) + ") & 1) != 0");
+        }
+        out << indent << "}\n";
+        break;
+      }
+      case CellType::BUILTIN:
+      {
+        // Word-level primitives are simple enough to inline, one local per bit.
+        if (const auto word = builtin::word_op(*netlist.builtins[cell.payload]); word != builtin::WordOp::NONE)
+        {
+          struct CodeLogic
+          {
+            std::ostringstream& out;
+            std::string         indent;
+            std::size_t         count{};
+
+            auto emit(const std::string& value) -> std::string
+            {
+              const auto local = "w" + std::to_string(count++);
+              out << indent << "const bool " << local << " = " << value << ";\n";
+              return local;
+            }
+
+            auto land(const std::string& a, const std::string& b) { return emit(a + " && " + b); }
+            auto lor(const std::string& a, const std::string& b) { return emit(a + " || " + b); }
+            auto lxor(const std::string& a, const std::string& b) { return emit(a + " != " + b); }
+            auto lnot(const std::string& a) { return emit("!" + a); }
+            auto mux(const std::string& sel, const std::string& a, const std::string& b) { return emit(sel + " ? " + b + " : " + a); }
+            auto constant(bool on) -> std::string { return on ? "true" : "false"; }
+          };
+
+          std::string ins[builtin::WORD_MAX_INPUTS];
+          std::string outs[builtin::WORD_MAX_OUTPUTS];
+          for (std::size_t i = 0; i < cell.input_count; i++)
+          {
+            ins[i] = in(i);
+          }
+
+          out << indent << "{\n";
+          CodeLogic logic{ out, indent + "  " };
+          builtin::word_lower(word, ins, outs, logic);
+          for (std::size_t o = 0; o < cell.output_count; o++)
+          {
+            assign(o, outs[o]);
+          }
+          out << indent << "}\n";
+          break;
+        }
+
+        const bool sequential = cell.sequential;
+        out << indent << "{\n" << indent << "  const std::uint8_t in[" << cell.input_count << "]{ ";
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          out << (i ? ", " : "") << in(i);
+        }
+        out << " };\n";
+
+        auto body = indent + "  ";
+        if (sequential)
+        {
+          // Only evaluated again once its inputs change.
+          const auto last = "state + " + std::to_string(layout.inputs_of[c]);
+          out << body << "bool stale = state[0] == 0;\n";
+          out << body << "for (unsigned i = 0; i < " << cell.input_count << "; i++) stale |= (" << last << ")[i] != in[i];\n";
+          out << body << "if (stale)\n" << body << "{\n";
+          body += "  ";
+          out << body << "for (unsigned i = 0; i < " << cell.input_count << "; i++) (" << last << ")[i] = in[i];\n";
+        }
+
+        out << body << "std::uint8_t result[" << cell.output_count << "];\n";
+        out << body << "host->builtin(host->simulator, " << cell.payload << ", in, result);\n";
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          assign(o, "result[" + std::to_string(o) + "] != 0");
+        }
+
+        if (sequential)
+        {
+          out << indent << "  }\n";
+        }
+        out << indent << "}\n";
+        break;
+      }
+    }
+  };
+
+  const auto emit_edge = [&](const std::string& indent) {
+    for (std::size_t c = netlist.sequential_begin; c < netlist.cells.size(); c++)
+    {
+      const auto& cell = netlist.cells[c];
+      if (cell.type == CellType::DFF)
+      {
+        out << indent << "const bool s" << c << " = " << net(netlist.input_of(cell, 0)) << ";\n";
+      }
+      else if (cell.type == CellType::BUILTIN)
+      {
+        out << indent << "{\n" << indent << "  const std::uint8_t in[" << cell.input_count << "]{ ";
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          out << (i ? ", " : "") << net(netlist.input_of(cell, i));
+        }
+        out << " };\n" << indent << "  host->sample(host->simulator, " << cell.payload << ", in);\n" << indent << "}\n";
+      }
+    }
+
+    for (std::size_t c = netlist.sequential_begin; c < netlist.cells.size(); c++)
+    {
+      const auto& cell = netlist.cells[c];
+      if (cell.type == CellType::DFF)
+      {
+        out << indent << net(netlist.output_of(cell, 0)) << " = s" << c << ";\n";
+      }
+      else if (cell.type == CellType::BUILTIN)
+      {
+        out << indent << "{\n" << indent << "  std::uint8_t result[" << cell.output_count << "];\n";
+        out << indent << "  host->commit(host->simulator, " << cell.payload << ", result);\n";
+        for (std::size_t o = 0; o < cell.output_count; o++)
+        {
+          out << indent << "  " << net(netlist.output_of(cell, o)) << " = result[" << o << "] != 0;\n";
+        }
+        out << indent << "}\n";
+      }
+    }
+  };
+
+  out << NATIVE_PREAMBLE << '\n';
+  out << "// " << netlist.name << ": " << netlist.cells.size() << " cells, " << netlist.net_count << " nets.\n";
+  out << "extern \"C\" int " << NATIVE_SYMBOL << "(const NativeHost* host, const std::uint8_t* in, std::uint8_t* out, std::uint8_t* state, std::uint64_t edges)\n{\n";
+
+  for (NetId n = 0; n < netlist.net_count; n++)
+  {
+    if (n < netlist.input_count) out << "  bool " << net(n) << " = in[" << n << "] != 0;\n";
+    else if (layout.slot_of[n] != 0) out << "  bool " << net(n) << " = state[" << layout.slot_of[n] << "] != 0;\n";
+    else out << "  bool " << net(n) << " = false;\n";
+  }
+
+  out << "  int settled = 1;\n\n";
+  out << "  for (std::uint64_t edge = 0; ; edge++)\n  {\n";
+  out << "    int stable = 0;\n";
+  out << "    for (int pass = 0; pass < " << SETTLE_LIMIT << " && !stable; pass++)\n    {\n";
+  out << "      int oscillating = 0;\n";
+
+  for (std::size_t c = 0; c < netlist.feedback_begin; c++)
+  {
+    emit_cell(netlist.cells[c], c, "      ", false);
+  }
+
+  for (const auto& group : netlist.feedback_groups)
+  {
+    if (!group.cyclic)
+    {
+      out << '\n';
+      for (std::size_t c = group.begin; c < group.end; c++)
+      {
+        emit_cell(netlist.cells[c], c, "      ", false);
+      }
+      continue;
+    }
+
+    out << "\n      for (int loop = 0; ; loop++)\n      {\n        bool changed = false;\n";
+    for (std::size_t c = group.begin; c < group.end; c++)
+    {
+      emit_cell(netlist.cells[c], c, "        ", true);
+    }
+    out << "        if (!changed) break;\n";
+    out << "        if (loop == " << SETTLE_LIMIT - 1 << ") { oscillating = 1; break; }\n      }\n";
+  }
+
+  out << "\n      bool changed = false;\n";
+  for (std::size_t c = netlist.sequential_begin; c < netlist.cells.size(); c++)
+  {
+    emit_cell(netlist.cells[c], c, "      ", true);
+  }
+  out << "      state[0] = 1;\n";
+  out << "      stable = !changed;\n";
+  out << "      if (stable && oscillating) settled = 0;\n    }\n";
+  out << "    settled &= stable;\n\n";
+  out << "    if (edge == edges) break;\n\n";
+  emit_edge("    ");
+  out << "  }\n\n";
+
+  for (NetId n = 0; n < netlist.net_count; n++)
+  {
+    if (layout.slot_of[n] != 0) out << "  state[" << layout.slot_of[n] << "] = " << net(n) << ";\n";
+  }
+  for (std::size_t o = 0; o < netlist.output_nets.size(); o++)
+  {
+    out << "  out[" << o << "] = " << net(netlist.output_nets[o]) << ";\n";
+  }
+
+  out << "  return settled;\n}\n";
+  return out.str();
+}
+
+/**
+ * A netlist compiled into a shared object and loaded into the process. Shared by
+ * every instance of the chip, the library is unloaded along with the last one.
+ */
+class NativeChip
+{
+public:
+  NativeChip(std::shared_ptr<const Netlist> netlist, void* library, NativeStep step, std::filesystem::path path)
+  : netlist(std::move(netlist))
+  , layout(*this->netlist)
+  , library(library)
+  , step(step)
+  , path(std::move(path))
+  {
+  }
+
+  NativeChip(const NativeChip&) = delete;
+  auto operator=(const NativeChip&) -> NativeChip& = delete;
+
+  ~NativeChip()
+  {
+#ifdef NATIVE_DLOPEN
+    dlclose(library);
+#endif
+  }
+
+  std::shared_ptr<const Netlist> netlist;
+  NativeLayout                   layout;
+  void*                          library;
+  NativeStep                     step;
+  std::filesystem::path          path;
+};
+
+#ifdef NATIVE_DLOPEN
+/**
+ * Whether path is a file (or directory) of ours that nobody else can write to,
+ * and not a symlink to one. Anything else in the cache could have been planted.
+ */
+inline auto owned_privately(const std::filesystem::path& path, bool directory) -> bool
+{
+  struct stat info{};
+
+  if (lstat(path.c_str(), &info) != 0 || info.st_uid != geteuid())
+  {
+    return false;
+  }
+
+  if (directory)
+  {
+    return S_ISDIR(info.st_mode) && (info.st_mode & 077) == 0;
+  }
+
+  return S_ISREG(info.st_mode) && (info.st_mode & 022) == 0;
+}
+
+/**
+ * Directory the generated sources and libraries are kept in: digital-logic-native
+ * under $XDG_CACHE_HOME (or ~/.cache), created 0700. They are named after the hash
+ * of their source, so an unchanged chip is only compiled once. Returns an empty
+ * path and fills in error if the directory isn't ours alone.
+ */
+inline auto native_directory(std::string& error) -> std::filesystem::path
+{
+  std::filesystem::path cache{};
+
+  if (const auto* xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && *xdg == '/')
+  {
+    cache = xdg;
+  }
+  else if (const auto* home = std::getenv("HOME"); home != nullptr && *home == '/')
+  {
+    cache = std::filesystem::path(home) / ".cache";
+  }
+  else
+  {
+    error = "Neither $XDG_CACHE_HOME nor $HOME is set, nowhere to keep native code.";
+    return {};
+  }
+
+  std::error_code ec{};
+  std::filesystem::create_directories(cache, ec);
+
+  const auto directory = cache / "digital-logic-native";
+  mkdir(directory.c_str(), 0700);
+
+  if (!owned_privately(directory, true))
+  {
+    error = directory.string() + " must be a directory owned by you with mode 0700.";
+    return {};
+  }
+
+  return directory;
+}
+#endif
+
+/**
+ * Generate, compile (with $CXX, or c++) and load the code of a netlist.
+ * Returns nullptr and fills in error if any of it fails.
+ */
+inline auto compile_native(std::shared_ptr<const Netlist> netlist, std::string& error) -> std::shared_ptr<const NativeChip>
+{
+#ifdef NATIVE_DLOPEN
+  const auto source = emit_source(*netlist);
+  const auto key = table_cache::hash_string(table_cache::HASH_SEED, source);
+
+  std::ostringstream stem{};
+  stem << netlist->name << '-' << std::hex << key;
+
+  const auto directory = native_directory(error);
+  if (directory.empty())
+  {
+    return nullptr;
+  }
+
+  const auto library_path = directory / (stem.str() + ".so");
+
+  // A library left by an earlier run is only reused if it is still ours alone.
+  if (!owned_privately(library_path, false))
+  {
+    const auto source_path = directory / (stem.str() + ".cpp");
+    const auto log_path = directory / (stem.str() + ".log");
+
+    // Built under a fresh name and moved into place, never over somebody else's file.
+    auto temporary_name = (directory / (stem.str() + ".so.XXXXXX")).string();
+    const auto descriptor = mkstemp(temporary_name.data());
+    if (descriptor < 0)
+    {
+      error = "Failed to create a temporary file in " + directory.string();
+      return nullptr;
+    }
+    close(descriptor);
+    const std::filesystem::path temporary_path{ temporary_name };
+
+    std::error_code ec{};
+
+    std::ofstream source_file(source_path, std::ios::trunc);
+    source_file << source;
+    source_file.close();
+
+    if (!source_file)
+    {
+      std::filesystem::remove(temporary_path, ec);
+      error = "Failed to write " + source_path.string();
+      return nullptr;
+    }
+
+    const auto* cxx = std::getenv("CXX");
+    const auto command = std::string(cxx != nullptr ? cxx : "c++")
+      + " -std=c++17 -O2 -shared -fPIC -o \"" + temporary_path.string() + "\" \"" + source_path.string() + "\""
+      + " > \"" + log_path.string() + "\" 2>&1";
+
+    if (std::system(command.c_str()) != 0)
+    {
+      std::filesystem::remove(temporary_path, ec);
+      error = "Compiler failed, see " + log_path.string();
+      return nullptr;
+    }
+
+    chmod(temporary_path.c_str(), 0700);
+    std::filesystem::rename(temporary_path, library_path, ec);
+    if (ec)
+    {
+      std::filesystem::remove(temporary_path, ec);
+      error = "Failed to move " + temporary_path.string() + ": " + ec.message();
+      return nullptr;
+    }
+
+    if (!owned_privately(library_path, false))
+    {
+      error = library_path.string() + " was tampered with, not loading it.";
+      return nullptr;
+    }
+  }
+
+  auto* library = dlopen(library_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (library == nullptr)
+  {
+    error = dlerror();
+    return nullptr;
+  }
+
+  auto step = reinterpret_cast<NativeStep>(dlsym(library, NATIVE_SYMBOL));
+  if (step == nullptr)
+  {
+    error = "Missing " + std::string(NATIVE_SYMBOL) + " in " + library_path.string();
+    dlclose(library);
+    return nullptr;
+  }
+
+  return std::make_shared<const NativeChip>(std::move(netlist), library, step, library_path);
+#else
+  error = "Native code generation needs dlopen, which this platform doesn't have.";
+  return nullptr;
+#endif
+}
+
+/**
+ * Per instance state of a chip running on native code, the counterpart of Interpreter.
+ */
+class NativeSimulator
+{
+public:
+  explicit NativeSimulator(std::shared_ptr<const NativeChip> chip)
+  : chip(std::move(chip))
+  , state(this->chip->layout.state_size, 0)
+  {
+    const auto& netlist = *this->chip->netlist;
+
+    // Only read through here, serializing a chip again swaps out the table itself.
+    for (const auto* table : netlist.tables)
+    {
+      tables.push_back(table->data());
+    }
+
+    builtins.reserve(netlist.builtins.size());
+    for (auto* prototype : netlist.builtins)
+    {
+      builtins.push_back(prototype->duplicate());
+    }
+
+    host = { tables.data(), this, &NativeSimulator::evaluate_builtin, &NativeSimulator::sample_builtin, &NativeSimulator::commit_builtin };
+  }
+
+  NativeSimulator(const NativeSimulator&) = delete;
+  auto operator=(const NativeSimulator&) -> NativeSimulator& = delete;
+
+  /**
+   * in and out hold one byte per pin. Settles the chip and runs the given number
+   * of clock cycles (see Gate::tick). Returns false if the chip did not settle.
+   */
+  auto step(const std::uint8_t* in, std::uint8_t* out, std::size_t cycles = 0) -> bool
+  {
+    return chip->step(&host, in, out, state.data(), cycles) != 0;
+  }
+
+private:
+  static auto evaluate_builtin(void* simulator, std::uint32_t index, const std::uint8_t* in, std::uint8_t* out) -> void
+  {
+    auto& gate = *static_cast<NativeSimulator*>(simulator)->builtins[index];
+
+    for (std::size_t i = 0; i < gate.input_pins.size(); i++)
+    {
+      gate.input_pins[i].set(in[i] != 0);
+    }
+
+    gate.simulate();
+
+    for (std::size_t o = 0; o < gate.output_pins.size(); o++)
+    {
+      out[o] = gate.output_pins[o].is_active();
+    }
+  }
+
+  static auto sample_builtin(void* simulator, std::uint32_t index, const std::uint8_t* in) -> void
+  {
+    auto& gate = *static_cast<NativeSimulator*>(simulator)->builtins[index];
+
+    for (std::size_t i = 0; i < gate.input_pins.size(); i++)
+    {
+      gate.input_pins[i].set(in[i] != 0);
+    }
+
+    gate.sample();
+  }
+
+  static auto commit_builtin(void* simulator, std::uint32_t index, std::uint8_t* out) -> void
+  {
+    auto& gate = *static_cast<NativeSimulator*>(simulator)->builtins[index];
+
+    gate.commit();
+
+    for (std::size_t o = 0; o < gate.output_pins.size(); o++)
+    {
+      out[o] = gate.output_pins[o].is_active();
+    }
+  }
+
+  std::shared_ptr<const NativeChip>  chip;
+  std::vector<std::uint8_t>          state;
+  std::vector<const std::uint64_t*>  tables{};
+  std::vector<std::unique_ptr<Gate>> builtins{};
+  NativeHost                         host{};
+};
+
+} /* namespace netlist */
+
+#endif /* NETLIST_NATIVE_H */
@@ -0,0 +1,336 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_H
+#define NETLIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../truth_table.hpp"
+
+struct Gate;
+
+namespace netlist
+{
+
+/**
+ * Net ID 0..(input_count-1) are the chip's global input pins, the net right
+ * after them is tied low and is used for any pin that nothing drives.
+ */
+using NetId = std::uint32_t;
+
+/**
+ * Upper bound on the number of passes a settle may take before we give up
+ * on the circuit ever becoming stable.
+ */
+constexpr std::size_t SETTLE_LIMIT{ 64 };
+
+/**
+ * The primitive cells which survive flattening.
+ */
+enum class CellType : std::uint8_t
+{
+  NAND,    // Two inputs, one output.
+  DFF,     // Level sensitive latch, output holds while clock is low.
+  TABLE,   // Serialized chip, evaluated as a lookup into its truth table.
+  BUILTIN, // One of the chips found in 'builtin/', evaluated through a private instance.
+};
+
+struct Cell
+{
+  CellType      type;
+  bool          sequential;   // Holds state, its outputs are treated as sources when levelizing.
+  std::uint16_t input_count;
+  std::uint16_t output_count;
+  std::uint32_t first_pin;    // Offset into Netlist::pins, inputs come first then outputs.
+  std::uint32_t payload;      // Index into Netlist::tables or Netlist::builtins.
+};
+
+/**
+ * A run of feedback cells, see Netlist::order_feedback.
+ */
+struct FeedbackGroup
+{
+  std::uint32_t begin;
+  std::uint32_t end;
+  bool          cyclic;  // A strongly connected component, evaluated until it stops changing.
+};
+
+/**
+ * A flat, levelized view of a chip. Every custom (non serialized) subgate has
+ * been dissolved, leaving only primitive cells wired through integer net IDs.
+ *
+ * Cells are stored in evaluation order:
+ *  - combinational cells, grouped by level (see level_offsets),
+ *  - combinational cells which sit on or behind a feedback loop (see feedback_groups),
+ *  - sequential cells.
+ */
+struct Netlist
+{
+  std::string                                  name{};
+  std::size_t                                  input_count{};
+  std::size_t                                  net_count{};
+  std::vector<Cell>                            cells{};
+  std::vector<NetId>                           pins{};
+  std::vector<NetId>                           output_nets{};
+  std::vector<std::uint32_t>                   level_offsets{};
+
+  /**
+   * Compressed fan-out of every net, the cells reading net N are
+   * fanout_cells[fanout_offsets[N] .. fanout_offsets[N + 1]).
+   */
+  std::vector<std::uint32_t>                   fanout_offsets{};
+  std::vector<std::uint32_t>                   fanout_cells{};
+  std::uint32_t                                feedback_begin{};
+  std::uint32_t                                sequential_begin{};
+  std::vector<FeedbackGroup>                   feedback_groups{};
+
+  /**
+   * Truth tables of serialized subgates and prototypes of builtin subgates.
+   * Both are owned by the board's component images.
+   */
+  std::vector<const TruthTable*>               tables{};
+  std::vector<Gate*>                           builtins{};
+
+  auto zero_net() const -> NetId
+  {
+    return static_cast<NetId>(input_count);
+  }
+
+  auto level_count() const -> std::size_t
+  {
+    return level_offsets.empty() ? 0 : level_offsets.size() - 1;
+  }
+
+  auto input_of(const Cell& cell, std::size_t n) const -> NetId
+  {
+    return pins[cell.first_pin + n];
+  }
+
+  auto output_of(const Cell& cell, std::size_t n) const -> NetId
+  {
+    return pins[cell.first_pin + cell.input_count + n];
+  }
+
+  auto fanout_begin(NetId net) const -> const std::uint32_t*
+  {
+    return fanout_cells.data() + fanout_offsets[net];
+  }
+
+  auto fanout_end(NetId net) const -> const std::uint32_t*
+  {
+    return fanout_cells.data() + fanout_offsets[net + 1];
+  }
+
+  auto has_feedback() const -> bool
+  {
+    return feedback_begin != sequential_begin;
+  }
+
+  auto has_sequential() const -> bool
+  {
+    return sequential_begin != cells.size();
+  }
+
+  /**
+   * Sort the feedback cells into groups, each one only reading nets of the groups
+   * before it. Every loop (strongly connected component) becomes a cyclic group of
+   * its own, evaluated until it settles on its own; the cells between them are only
+   * evaluated once. Cells move around, so build_fanout has to come after.
+   */
+  auto order_feedback() -> void
+  {
+    constexpr auto NONE = static_cast<std::uint32_t>(-1);
+
+    const auto begin = feedback_begin;
+    const auto count = sequential_begin - feedback_begin;
+    feedback_groups.clear();
+
+    if (count == 0) return;
+
+    // Which feedback cell drives each net, loops only ever go through those.
+    std::vector<std::uint32_t> driver(net_count, NONE);
+    for (std::uint32_t c = 0; c < count; c++)
+    {
+      const auto& cell = cells[begin + c];
+      for (std::size_t o = 0; o < cell.output_count; o++)
+      {
+        driver[output_of(cell, o)] = c;
+      }
+    }
+
+    // Tarjan's algorithm on the cells' inputs, without recursion: a component is
+    // complete once all of its drivers are, so they come out drivers first.
+    std::vector<std::uint32_t> index(count, NONE);
+    std::vector<std::uint32_t> low(count, 0);
+    std::vector<bool>          on_stack(count, false);
+    std::vector<std::uint32_t> stack{};
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> path{};  // Cell and next input to visit.
+    std::vector<std::uint32_t> order{};
+    std::uint32_t              next_index = 0;
+
+    for (std::uint32_t root = 0; root < count; root++)
+    {
+      if (index[root] != NONE) continue;
+      path.push_back({ root, 0 });
+
+      while (!path.empty())
+      {
+        auto& [c, input] = path.back();
+        const auto& cell = cells[begin + c];
+
+        if (input == 0 && index[c] == NONE)
+        {
+          index[c] = low[c] = next_index++;
+          stack.push_back(c);
+          on_stack[c] = true;
+        }
+
+        if (input < cell.input_count)
+        {
+          const auto d = driver[input_of(cell, input++)];
+          if (d == NONE) continue;
+
+          if (index[d] == NONE)
+          {
+            path.push_back({ d, 0 });
+          }
+          else if (on_stack[d])
+          {
+            low[c] = std::min(low[c], index[d]);
+          }
+          continue;
+        }
+
+        const auto done = c;
+        path.pop_back();
+
+        if (low[done] == index[done])
+        {
+          const auto first = static_cast<std::uint32_t>(order.size());
+          std::uint32_t member{};
+          do
+          {
+            member = stack.back();
+            stack.pop_back();
+            on_stack[member] = false;
+            order.push_back(member);
+          } while (member != done);
+
+          // A lone cell is only a loop if it reads its own output.
+          bool cyclic = order.size() - first > 1;
+          for (std::size_t i = 0; !cyclic && i < cell.input_count; i++)
+          {
+            cyclic = driver[input_of(cell, i)] == done;
+          }
+
+          const auto group_begin = begin + first;
+          const auto group_end = begin + static_cast<std::uint32_t>(order.size());
+
+          if (!cyclic && !feedback_groups.empty() && !feedback_groups.back().cyclic)
+          {
+            feedback_groups.back().end = group_end;
+          }
+          else
+          {
+            feedback_groups.push_back({ group_begin, group_end, cyclic });
+          }
+        }
+
+        if (!path.empty())
+        {
+          const auto parent = path.back().first;
+          low[parent] = std::min(low[parent], low[done]);
+        }
+      }
+    }
+
+    std::vector<Cell> sorted{};
+    sorted.reserve(count);
+    for (auto c : order)
+    {
+      sorted.push_back(cells[begin + c]);
+    }
+    std::copy(sorted.begin(), sorted.end(), cells.begin() + begin);
+  }
+
+  /**
+   * Number of feedback loops, see order_feedback.
+   */
+  auto loop_count() const -> std::size_t
+  {
+    std::size_t loops = 0;
+    for (const auto& group : feedback_groups)
+    {
+      loops += group.cyclic;
+    }
+    return loops;
+  }
+
+  /**
+   * Fill in fanout_offsets/fanout_cells from the cells and their pins.
+   */
+  auto build_fanout() -> void
+  {
+    fanout_offsets.assign(net_count + 1, 0);
+
+    // A cell reading the same net twice (nand(a=in, b=in)) is only listed once.
+    auto for_each_read = [&](auto&& f) {
+      for (std::uint32_t c = 0; c < cells.size(); c++)
+      {
+        const auto& cell = cells[c];
+        for (std::size_t i = 0; i < cell.input_count; i++)
+        {
+          const auto net = input_of(cell, i);
+          bool seen = false;
+          for (std::size_t j = 0; j < i; j++)
+          {
+            seen |= input_of(cell, j) == net;
+          }
+          if (!seen) f(net, c);
+        }
+      }
+    };
+
+    for_each_read([&](NetId net, std::uint32_t) { fanout_offsets[net + 1]++; });
+
+    for (std::size_t n = 1; n < fanout_offsets.size(); n++)
+    {
+      fanout_offsets[n] += fanout_offsets[n - 1];
+    }
+
+    std::vector<std::uint32_t> cursor(fanout_offsets.begin(), fanout_offsets.end() - 1);
+    fanout_cells.resize(fanout_offsets.back());
+    for_each_read([&](NetId net, std::uint32_t c) { fanout_cells[cursor[net]++] = c; });
+  }
+};
+
+} /* namespace netlist */
+
+#endif /* NETLIST_H */
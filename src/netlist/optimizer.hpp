@@ -0,0 +1,486 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_OPTIMIZER_H
+#define NETLIST_OPTIMIZER_H
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "netlist.hpp"
+
+namespace netlist
+{
+
+/**
+ * Rewrites a netlist into a smaller one which computes the same outputs.
+ *
+ * Combinational cells are visited in level order, every output is either kept
+ * or replaced by an equivalent net which already exists:
+ *  - constant propagation: nand with a low input is high, tables whose outputs
+ *    don't depend on their non constant inputs (true.hdl) fold away,
+ *  - double inversions: not(not(x)) is x, nand(x, not(x)) is high,
+ *  - structural hashing: a cell with the same type and inputs as an earlier one
+ *    is the earlier one.
+ * Cells which no output depends on are then dropped. Builtins are always kept,
+ * they carry memory of their own.
+ *
+ * Feedback and sequential cells are never rewritten, only their inputs are.
+ */
+class Optimizer
+{
+public:
+  explicit Optimizer(const Netlist& source)
+  : source(source)
+  , alias(source.net_count)
+  {
+    for (NetId n = 0; n < alias.size(); n++)
+    {
+      alias[n] = n;
+    }
+  }
+
+  auto optimize() -> std::shared_ptr<Netlist>
+  {
+    for (std::uint32_t c = 0; c < source.cells.size(); c++)
+    {
+      const auto& cell = source.cells[c];
+      WorkCell work{ cell.type, cell.sequential, c >= source.feedback_begin, cell.payload, {}, {} };
+
+      for (std::size_t i = 0; i < cell.input_count; i++)
+      {
+        work.inputs.push_back(find(source.input_of(cell, i)));
+      }
+      for (std::size_t o = 0; o < cell.output_count; o++)
+      {
+        work.outputs.push_back(source.output_of(cell, o));
+      }
+
+      // Level cells are in topological order, their inputs are final by now.
+      if (!work.fixed && !simplify(work))
+      {
+        continue;
+      }
+
+      cells.push_back(std::move(work));
+    }
+
+    // Feedback and sequential cells may read nets which got replaced after them.
+    for (auto& cell : cells)
+    {
+      for (auto& net : cell.inputs)
+      {
+        net = find(net);
+      }
+    }
+
+    for (auto net : source.output_nets)
+    {
+      output_nets.push_back(find(net));
+    }
+
+    sweep();
+    return build();
+  }
+
+private:
+  struct WorkCell
+  {
+    CellType           type;
+    bool               sequential;
+    bool               fixed;      // Feedback or sequential, kept as is.
+    std::uint32_t      payload;
+    std::vector<NetId> inputs;
+    std::vector<NetId> outputs;
+    bool               live{};
+    std::uint32_t      level{};
+  };
+
+  auto find(NetId net) const -> NetId
+  {
+    return (net < alias.size()) ? alias[net] : net;
+  }
+
+  auto zero() const -> NetId
+  {
+    return source.zero_net();
+  }
+
+  /**
+   * A net which is always high, driven by nand(zero, zero) placed in front of
+   * every other cell. Only allocated if anything ends up reading it.
+   */
+  auto one() -> NetId
+  {
+    if (!one_net)
+    {
+      one_net = static_cast<NetId>(source.net_count);
+    }
+    return *one_net;
+  }
+
+  auto constant(NetId net) const -> std::optional<bool>
+  {
+    if (net == zero()) return false;
+    if (one_net && net == *one_net) return true;
+    return std::nullopt;
+  }
+
+  auto inverse_of(NetId net) const -> std::optional<NetId>
+  {
+    if (auto it = inverses.find(net); it != inverses.end()) return it->second;
+    return std::nullopt;
+  }
+
+  /**
+   * Returns false if every output of the cell has been replaced.
+   */
+  auto simplify(WorkCell& cell) -> bool
+  {
+    switch (cell.type)
+    {
+      case CellType::NAND: return simplify_nand(cell);
+      case CellType::TABLE: return simplify_table(cell);
+      default: return true;
+    }
+  }
+
+  auto simplify_nand(WorkCell& cell) -> bool
+  {
+    auto a = cell.inputs[0];
+    auto b = cell.inputs[1];
+    const auto out = cell.outputs[0];
+
+    const auto ca = constant(a);
+    const auto cb = constant(b);
+
+    if (ca == false || cb == false)
+    {
+      alias[out] = one();
+      return false;
+    }
+
+    if (ca == true && cb == true)
+    {
+      alias[out] = zero();
+      return false;
+    }
+
+    // nand(1, x) is not(x).
+    if (ca == true) a = b;
+    if (cb == true) b = a;
+
+    if (inverse_of(a) == b || inverse_of(b) == a)
+    {
+      alias[out] = one();
+      return false;
+    }
+
+    if (a == b)
+    {
+      if (auto x = inverse_of(a))
+      {
+        alias[out] = *x;
+        return false;
+      }
+    }
+
+    if (a > b) std::swap(a, b);
+    cell.inputs = { a, b };
+
+    const auto key = (static_cast<std::uint64_t>(a) << 32) | b;
+    if (auto [it, inserted] = nands.try_emplace(key, out); !inserted)
+    {
+      alias[out] = it->second;
+      return false;
+    }
+
+    if (a == b)
+    {
+      inverses[out] = a;
+    }
+
+    return true;
+  }
+
+  auto simplify_table(WorkCell& cell) -> bool
+  {
+    const auto& table = *source.tables[cell.payload];
+    const auto  input_count = cell.inputs.size();
+
+    // Only the rows matching the constant inputs can ever be looked up.
+    std::size_t fixed_mask = 0;
+    std::size_t fixed_bits = 0;
+    for (std::size_t i = 0; i < input_count; i++)
+    {
+      if (auto value = constant(cell.inputs[i]))
+      {
+        const auto bit = std::size_t{ 1 } << (input_count - 1 - i);
+        fixed_mask |= bit;
+        fixed_bits |= *value ? bit : 0;
+      }
+    }
+
+    bool any_left = false;
+
+    for (std::size_t o = 0; o < cell.outputs.size(); o++)
+    {
+      const auto shift = cell.outputs.size() - 1 - o;
+
+      // Outputs which are constant, or a copy of one of the inputs, over the reachable rows.
+      std::size_t seen[2]{};
+      std::vector<bool> copies(input_count, true);
+
+      for (std::size_t row = 0; row < table.rows(); row++)
+      {
+        if ((row & fixed_mask) != fixed_bits) continue;
+
+        const auto value = (table[row] >> shift) & 1;
+        seen[value]++;
+
+        for (std::size_t i = 0; i < input_count; i++)
+        {
+          copies[i] = copies[i] && (((row >> (input_count - 1 - i)) & 1) == value);
+        }
+      }
+
+      const auto out = cell.outputs[o];
+
+      if (seen[1] == 0) alias[out] = zero();
+      else if (seen[0] == 0) alias[out] = one();
+      else if (auto it = std::find(copies.begin(), copies.end(), true); it != copies.end())
+      {
+        alias[out] = cell.inputs[it - copies.begin()];
+      }
+      else any_left = true;
+    }
+
+    if (!any_left)
+    {
+      return false;
+    }
+
+    // The same table on the same inputs is the same cell.
+    if (auto [it, inserted] = tables.try_emplace({ &table, cell.inputs }, cells.size()); !inserted)
+    {
+      const auto& other = cells[it->second];
+      for (std::size_t o = 0; o < cell.outputs.size(); o++)
+      {
+        if (alias[cell.outputs[o]] == cell.outputs[o]) alias[cell.outputs[o]] = other.outputs[o];
+      }
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Mark every cell the outputs (or a builtin) depend on.
+   */
+  auto sweep() -> void
+  {
+    constexpr auto NONE = static_cast<std::uint32_t>(-1);
+
+    std::vector<std::uint32_t> driver(source.net_count, NONE);
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      for (auto net : cells[c].outputs)
+      {
+        driver[net] = c;
+      }
+    }
+
+    std::vector<std::uint32_t> pending{};
+    auto mark = [&](NetId net) {
+      if (net < driver.size() && driver[net] != NONE && !cells[driver[net]].live)
+      {
+        cells[driver[net]].live = true;
+        pending.push_back(driver[net]);
+      }
+      if (one_net && net == *one_net)
+      {
+        one_live = true;
+      }
+    };
+
+    for (auto net : output_nets) mark(net);
+    for (std::uint32_t c = 0; c < cells.size(); c++)
+    {
+      if (cells[c].type == CellType::BUILTIN && !cells[c].live)
+      {
+        cells[c].live = true;
+        pending.push_back(c);
+      }
+    }
+
+    while (!pending.empty())
+    {
+      const auto c = pending.back();
+      pending.pop_back();
+      for (auto net : cells[c].inputs) mark(net);
+    }
+  }
+
+  auto build() -> std::shared_ptr<Netlist>
+  {
+    auto result = std::make_shared<Netlist>();
+    result->name = source.name;
+    result->input_count = source.input_count;
+    result->tables = source.tables;
+    result->builtins = source.builtins;
+
+    // Inputs and the zero net keep their IDs, everything else is renumbered densely.
+    constexpr auto NONE = static_cast<NetId>(-1);
+    std::vector<NetId> renumber(source.net_count + 1, NONE);
+    for (NetId n = 0; n <= zero(); n++)
+    {
+      renumber[n] = n;
+    }
+    NetId next = zero() + 1;
+
+    std::vector<WorkCell> order{};
+    if (one_live)
+    {
+      order.push_back({ CellType::NAND, false, false, 0, { zero(), zero() }, { *one_net }, true, 0 });
+    }
+    for (auto& cell : cells)
+    {
+      if (cell.live) order.push_back(std::move(cell));
+    }
+
+    for (auto& cell : order)
+    {
+      for (auto net : cell.outputs) renumber[net] = next++;
+    }
+
+    // Levels are recomputed from scratch, a cell may have lost its deepest input.
+    std::vector<std::uint32_t> level_of(next, 0);
+    std::vector<bool>          from_level(next, false);
+    std::uint32_t              max_level = 0;
+    std::size_t                level_cells = 0;
+
+    for (auto& cell : order)
+    {
+      for (auto& net : cell.inputs) net = renumber[net];
+      for (auto& net : cell.outputs) net = renumber[net];
+
+      if (cell.fixed) continue;
+
+      for (auto net : cell.inputs)
+      {
+        if (from_level[net]) cell.level = std::max(cell.level, level_of[net] + 1);
+      }
+      for (auto net : cell.outputs)
+      {
+        level_of[net] = cell.level;
+        from_level[net] = true;
+      }
+
+      max_level = std::max(max_level, cell.level);
+      level_cells++;
+    }
+
+    // Fixed cells were already behind the level cells, a stable sort keeps them in place.
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+      if (a.fixed != b.fixed) return b.fixed;
+      return !a.fixed && a.level < b.level;
+    });
+
+    result->level_offsets.assign(level_cells == 0 ? 0 : max_level + 2, 0);
+    for (std::size_t c = 0; c < level_cells; c++)
+    {
+      result->level_offsets[order[c].level + 1]++;
+    }
+    for (std::size_t l = 1; l < result->level_offsets.size(); l++)
+    {
+      result->level_offsets[l] += result->level_offsets[l - 1];
+    }
+
+    result->feedback_begin = static_cast<std::uint32_t>(level_cells);
+    result->sequential_begin = static_cast<std::uint32_t>(order.size());
+
+    for (std::uint32_t c = 0; c < order.size(); c++)
+    {
+      const auto& cell = order[c];
+
+      if (cell.sequential && result->sequential_begin == order.size())
+      {
+        result->sequential_begin = c;
+      }
+
+      result->cells.push_back({
+        cell.type,
+        cell.sequential,
+        static_cast<std::uint16_t>(cell.inputs.size()),
+        static_cast<std::uint16_t>(cell.outputs.size()),
+        static_cast<std::uint32_t>(result->pins.size()),
+        cell.payload
+      });
+
+      result->pins.insert(result->pins.end(), cell.inputs.begin(), cell.inputs.end());
+      result->pins.insert(result->pins.end(), cell.outputs.begin(), cell.outputs.end());
+    }
+
+    for (auto net : output_nets)
+    {
+      result->output_nets.push_back(renumber[net]);
+    }
+
+    result->net_count = next;
+    result->order_feedback();
+    result->build_fanout();
+
+    return result;
+  }
+
+  /**
+   * Members.
+   */
+  const Netlist&                                                          source;
+  std::vector<NetId>                                                      alias;
+  std::optional<NetId>                                                    one_net{};
+  bool                                                                    one_live{};
+  std::vector<WorkCell>                                                   cells{};
+  std::vector<NetId>                                                      output_nets{};
+  std::unordered_map<NetId, NetId>                                        inverses{};
+  std::unordered_map<std::uint64_t, NetId>                                nands{};
+  std::map<std::pair<const TruthTable*, std::vector<NetId>>, std::size_t> tables{};
+};
+
+/**
+ * See Optimizer.
+ */
+inline auto optimize(const Netlist& netlist) -> std::shared_ptr<Netlist>
+{
+  return Optimizer(netlist).optimize();
+}
+
+} /* namespace netlist */
+
+#endif /* NETLIST_OPTIMIZER_H */
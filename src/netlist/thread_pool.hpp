@@ -0,0 +1,171 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef NETLIST_THREAD_POOL_H
+#define NETLIST_THREAD_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace netlist
+{
+
+/**
+ * Iterations a worker spins on a new job before going to sleep. Jobs come in bursts
+ * (one per level of a settle) which are over long before a sleeping thread wakes up.
+ */
+constexpr std::size_t POOL_SPIN_LIMIT{ 1 << 14 };
+
+/**
+ * A fixed set of worker threads running one job at a time. A job is a number of
+ * tasks which idle threads (the submitting one included) pull off a shared
+ * counter, so a thread done with its tasks takes over the others' remaining ones.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * Threads in total, including the one calling parallel_for.
+   */
+  explicit ThreadPool(std::size_t threads)
+  {
+    for (std::size_t t = 1; t < threads; t++)
+    {
+      workers.emplace_back([this] { work_loop(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+  ~ThreadPool()
+  {
+    stopping.store(true);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    for (auto& worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  /**
+   * The pool shared by every simulation, one thread per core.
+   */
+  static auto shared() -> ThreadPool&
+  {
+    static ThreadPool pool{ std::max(1u, std::thread::hardware_concurrency()) };
+    return pool;
+  }
+
+  auto size() const -> std::size_t
+  {
+    return workers.size() + 1;
+  }
+
+  /**
+   * Run task(i) for every i below count and return once all of them are done.
+   * Runs on the calling thread alone if the pool is busy (a nested call).
+   */
+  auto parallel_for(std::size_t count, const std::function<void(std::size_t)>& task) -> void
+  {
+    std::unique_lock<std::mutex> guard{ submit, std::try_to_lock };
+
+    if (workers.empty() || count < 2 || count > 0xFFFFFFFF || !guard.owns_lock())
+    {
+      for (std::size_t i = 0; i < count; i++) task(i);
+      return;
+    }
+
+    // The size of the job travels with its counter, a worker which wakes up late
+    // can only ever claim a task of the job it actually sees.
+    job.store(&task, std::memory_order_relaxed);
+    done.store(0, std::memory_order_relaxed);
+    next.store(static_cast<std::uint64_t>(count) << 32, std::memory_order_release);
+
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    run_tasks();
+
+    while (done.load(std::memory_order_acquire) != count)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  auto run_tasks() -> void
+  {
+    while (true)
+    {
+      const auto claim = next.fetch_add(1, std::memory_order_acq_rel);
+      const auto i = claim & 0xFFFFFFFF;
+      if (i >= (claim >> 32))
+      {
+        return;
+      }
+
+      (*job.load(std::memory_order_relaxed))(i);
+      done.fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  auto work_loop() -> void
+  {
+    auto seen = generation.load(std::memory_order_acquire);
+
+    while (true)
+    {
+      for (std::size_t spin = 0; spin < POOL_SPIN_LIMIT && generation.load(std::memory_order_acquire) == seen; spin++);
+      generation.wait(seen, std::memory_order_acquire);
+
+      seen = generation.load(std::memory_order_acquire);
+      if (stopping.load())
+      {
+        return;
+      }
+
+      run_tasks();
+    }
+  }
+
+  std::vector<std::thread>                                  workers{};
+  std::mutex                                                submit{};
+  std::atomic<std::uint64_t>                                generation{ 0 };
+  std::atomic<bool>                                         stopping{ false };
+  std::atomic<const std::function<void(std::size_t)>*>      job{ nullptr };
+  std::atomic<std::uint64_t>                                next{ 0 };       // Task count above, next task below.
+  std::atomic<std::size_t>                                  done{ 0 };
+};
+
+} /* namespace netlist */
+
+#endif /* NETLIST_THREAD_POOL_H */
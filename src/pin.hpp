@@ -26,10 +26,11 @@
 #ifndef PIN_H
 #define PIN_H
 
-#include <vector>
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
-class Wire;
+struct Wire;
 class Gate;
 
 enum class PinState
@@ -38,38 +39,188 @@ enum class PinState
   ACTIVE
 };
 
+/**
+ * Pin states are packed into planes of 64 bit words, one plane for the inputs
+ * and one for the outputs of every gate. Pin N lives in word N / 64, counting
+ * from the most significant bit, so a bus reads out in the same order as the
+ * pins are declared.
+ */
+using PinWord = std::uint64_t;
+constexpr std::size_t PIN_WORD_BITS{ 64 };
+
+constexpr auto plane_words(std::size_t pin_count) -> std::size_t
+{
+  return (pin_count + PIN_WORD_BITS - 1) / PIN_WORD_BITS;
+}
+
+/**
+ * Read the pins [start, end) as an unsigned value, the first pin being the most significant bit.
+ * Only the last 64 pins of a wider range make it into the result.
+ */
+inline auto plane_extract(const PinWord* plane, std::size_t start, std::size_t end) -> PinWord
+{
+  if (end <= start) return 0;
+  if (end - start > PIN_WORD_BITS) start = end - PIN_WORD_BITS;
+
+  const auto length = end - start;
+  const auto word = start / PIN_WORD_BITS;
+  const auto offset = start % PIN_WORD_BITS;
+
+  PinWord bits = plane[word] << offset;
+  if (offset + length > PIN_WORD_BITS)
+  {
+    bits |= plane[word + 1] >> (PIN_WORD_BITS - offset);
+  }
+
+  return bits >> (PIN_WORD_BITS - length);
+}
+
+/**
+ * Write value into the pins [start, end), the most significant bit going to the first pin.
+ */
+inline auto plane_insert(PinWord* plane, PinWord value, std::size_t start, std::size_t end) -> void
+{
+  if (end <= start) return;
+  if (end - start > PIN_WORD_BITS)
+  {
+    // Nothing of the value reaches the leading pins.
+    plane_insert(plane, 0, start, end - PIN_WORD_BITS);
+    start = end - PIN_WORD_BITS;
+  }
+
+  const auto length = end - start;
+  const auto word = start / PIN_WORD_BITS;
+  const auto offset = start % PIN_WORD_BITS;
+
+  // Left align both the value and its mask.
+  const PinWord mask = ~PinWord{ 0 } << (PIN_WORD_BITS - length);
+  const PinWord bits = (value << (PIN_WORD_BITS - length)) & mask;
+
+  plane[word] = (plane[word] & ~(mask >> offset)) | (bits >> offset);
+  if (offset + length > PIN_WORD_BITS)
+  {
+    const auto spill = PIN_WORD_BITS - offset;
+    plane[word + 1] = (plane[word + 1] & ~(mask << spill)) | (bits << spill);
+  }
+}
+
+/**
+ * Smallest unsigned type holding a bus of Width pins.
+ */
+template <std::size_t Width>
+using BusValue = std::conditional_t<(Width <= 8), std::uint8_t,
+                 std::conditional_t<(Width <= 16), std::uint16_t,
+                 std::conditional_t<(Width <= 32), std::uint32_t, std::uint64_t>>>;
+
+/**
+ * plane_extract and plane_insert for a range known at compile time, which come
+ * down to a shift and a mask (two when the range straddles a word).
+ */
+template <std::size_t Start, std::size_t Width>
+inline auto plane_read(const PinWord* plane) -> PinWord
+{
+  static_assert(Width > 0 && Width <= PIN_WORD_BITS, "A bus is 1 to 64 pins wide.");
+  constexpr auto word = Start / PIN_WORD_BITS;
+  constexpr auto offset = Start % PIN_WORD_BITS;
+
+  PinWord bits = plane[word] << offset;
+  if constexpr (offset + Width > PIN_WORD_BITS)
+  {
+    bits |= plane[word + 1] >> (PIN_WORD_BITS - offset);
+  }
+
+  return bits >> (PIN_WORD_BITS - Width);
+}
+
+template <std::size_t Start, std::size_t Width>
+inline auto plane_write(PinWord* plane, PinWord value) -> void
+{
+  static_assert(Width > 0 && Width <= PIN_WORD_BITS, "A bus is 1 to 64 pins wide.");
+  constexpr auto word = Start / PIN_WORD_BITS;
+  constexpr auto offset = Start % PIN_WORD_BITS;
+  constexpr PinWord mask = ~PinWord{ 0 } << (PIN_WORD_BITS - Width);
+
+  const PinWord bits = (value << (PIN_WORD_BITS - Width)) & mask;
+
+  plane[word] = (plane[word] & ~(mask >> offset)) | (bits >> offset);
+  if constexpr (offset + Width > PIN_WORD_BITS)
+  {
+    constexpr auto spill = PIN_WORD_BITS - offset;
+    plane[word + 1] = (plane[word + 1] & ~(mask << spill)) | (bits << spill);
+  }
+}
+
+/**
+ * A run of wires sharing the same source pin, stored contiguously inside a gate (see Gate::index_wires).
+ */
+struct WireSpan
+{
+  const Wire*   first{ nullptr };
+  std::uint32_t count{};
+
+  inline auto begin() const -> const Wire*;
+  inline auto end() const -> const Wire*;
+};
+
+/**
+ * A pin doesn't hold its state, it refers to its bit in the plane of the gate owning it.
+ * Copies of a pin refer to the same bit.
+ */
 struct Pin
 {
-  PinState state;
-  std::vector<std::shared_ptr<Wire>> connections;
+  PinWord*      plane{ nullptr };
+  std::uint32_t index{};
   Gate* parent;
 
+  /**
+   * Wires leaving this pin. The inner ones belong to the gate owning the pin,
+   * the outer ones to the gate holding the owner as a subgate.
+   */
+  WireSpan inner{};
+  WireSpan outer{};
+
   Pin(Gate* p = nullptr)
-  : state{ PinState::INACTIVE }
-  , parent(p)
+  : parent(p)
   {
   }
 
   ~Pin() = default;
 
-  [[nodiscard]] PinState get_state()
+  void bind(PinWord* pin_plane, std::size_t pin_index)
+  {
+    plane = pin_plane;
+    index = static_cast<std::uint32_t>(pin_index);
+  }
+
+  [[nodiscard]] PinState get_state() const
+  {
+    return is_active() ? PinState::ACTIVE : PinState::INACTIVE;
+  }
+
+  void set_state(PinState state)
   {
-    return state;
+    set(state == PinState::ACTIVE);
   }
 
   bool is_active() const
   {
-    return state == PinState::ACTIVE;
+    return ((plane[index / PIN_WORD_BITS] >> bit()) & 1) == 1;
+  }
+
+  void set(bool on)
+  {
+    auto& word = plane[index / PIN_WORD_BITS];
+    word = (word & ~(PinWord{ 1 } << bit())) | (static_cast<PinWord>(on) << bit());
   }
 
   void set_on()
   {
-    state = PinState::ACTIVE;
+    set(true);
   }
 
   void set_off()
   {
-    state = PinState::INACTIVE;
+    set(false);
   }
 
   void reset()
@@ -79,7 +230,7 @@ struct Pin
 
   void flip()
   {
-    state = is_active() ? PinState::INACTIVE : PinState::ACTIVE;
+    plane[index / PIN_WORD_BITS] ^= PinWord{ 1 } << bit();
   }
 
   bool has_parent()
@@ -87,8 +238,11 @@ struct Pin
     return parent != nullptr;
   }
 
+private:
+  auto bit() const -> std::size_t
+  {
+    return PIN_WORD_BITS - 1 - (index % PIN_WORD_BITS);
+  }
 };
 
-
-
 #endif /* PIN_H */
@@ -0,0 +1,195 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TABLE_CACHE_MMAP
+#endif
+
+#include "truth_table.hpp"
+
+/**
+ * Truth tables of precomputed chips are kept on disk next to their '.gate'
+ * file, so a chip only has to be serialized again once it (or anything it is
+ * built out of) changes.
+ *
+ * A cache file is a small header followed by the packed rows of the table:
+ *   magic, version, key, input count, output count (8 bytes each), rows...
+ *
+ * The key is the content hash of the chip (see Gate::content_hash), a file
+ * whose key doesn't match is simply recomputed and overwritten.
+ */
+namespace table_cache
+{
+
+constexpr std::uint64_t MAGIC{ 0x454C4241'54544C44 }; // "DLTTABLE"
+constexpr std::uint64_t VERSION{ 1 };
+
+struct Header
+{
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t key;
+  std::uint64_t input_count;
+  std::uint64_t output_count;
+};
+
+/**
+ * FNV-1a, used to build content hashes.
+ */
+constexpr std::uint64_t HASH_SEED{ 0xcbf29ce484222325 };
+
+inline auto hash_bytes(std::uint64_t hash, const void* bytes, std::size_t size) -> std::uint64_t
+{
+  const auto* data = static_cast<const unsigned char*>(bytes);
+  for (std::size_t i = 0; i < size; i++)
+  {
+    hash ^= data[i];
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+inline auto hash_value(std::uint64_t hash, std::uint64_t value) -> std::uint64_t
+{
+  return hash_bytes(hash, &value, sizeof(value));
+}
+
+inline auto hash_string(std::uint64_t hash, std::string_view str) -> std::uint64_t
+{
+  return hash_value(hash_bytes(hash, str.data(), str.size()), str.size());
+}
+
+/**
+ * Load the table stored at path if it was built for the given key and pin counts.
+ * The rows are mapped straight from the file where the platform allows it.
+ */
+inline auto load(const std::string& path, std::uint64_t key, std::size_t input_count, std::size_t output_count) -> std::optional<TruthTable>
+{
+  const auto payload = TruthTable::word_count(input_count, output_count) * sizeof(TruthTable::Word);
+  const auto expected_size = sizeof(Header) + payload;
+
+  const auto matches = [&](const Header& header) {
+    return header.magic == MAGIC
+        && header.version == VERSION
+        && header.key == key
+        && header.input_count == input_count
+        && header.output_count == output_count;
+  };
+
+#ifdef TABLE_CACHE_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return std::nullopt;
+  }
+
+  struct stat info{};
+  if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) != expected_size)
+  {
+    ::close(fd);
+    return std::nullopt;
+  }
+
+  void* address = ::mmap(nullptr, expected_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+
+  if (address == MAP_FAILED)
+  {
+    return std::nullopt;
+  }
+
+  std::shared_ptr<const void> mapping{ address, [expected_size](const void* p) { ::munmap(const_cast<void*>(p), expected_size); } };
+
+  Header header{};
+  std::memcpy(&header, address, sizeof(Header));
+  if (!matches(header))
+  {
+    return std::nullopt;
+  }
+
+  const auto* rows = reinterpret_cast<const TruthTable::Word*>(static_cast<const char*>(address) + sizeof(Header));
+  return TruthTable::borrow(input_count, output_count, std::move(mapping), rows);
+#else
+  std::ifstream file{ path, std::ios::binary };
+
+  Header header{};
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header)) || !matches(header))
+  {
+    return std::nullopt;
+  }
+
+  auto words = std::make_shared<std::vector<TruthTable::Word>>(payload / sizeof(TruthTable::Word));
+  if (!file.read(reinterpret_cast<char*>(words->data()), payload) || file.peek() != std::ifstream::traits_type::eof())
+  {
+    return std::nullopt;
+  }
+
+  const auto* rows = words->data();
+  return TruthTable::borrow(input_count, output_count, std::move(words), rows);
+#endif
+}
+
+/**
+ * Write the table to path under the given key, replacing whatever was there.
+ */
+inline auto store(const std::string& path, std::uint64_t key, std::size_t input_count, const TruthTable& table) -> bool
+{
+  // Write to the side and move it over, a process mapping the old file keeps its copy.
+  const auto temporary = path + ".tmp";
+
+  {
+    std::ofstream file{ temporary, std::ios::binary | std::ios::trunc };
+
+    const Header header{ MAGIC, VERSION, key, input_count, table.output_count() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.memory()));
+
+    if (!file)
+    {
+      return false;
+    }
+  }
+
+  return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+} /* namespace table_cache */
+
+#endif /* TABLE_CACHE_H */
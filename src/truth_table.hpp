@@ -0,0 +1,200 @@
+/** 
+ * MIT License
+ * 
+ * Copyright (c) 2023 Ochawin A.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#ifndef TRUTH_TABLE_H
+#define TRUTH_TABLE_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Precomputed outputs of a chip, one row per input combination. The row index
+ * is the input pins read as a number (first pin being the most significant bit),
+ * the row value is the output pins read the same way.
+ *
+ * Rows are packed back to back using exactly one bit per output, a 16 input
+ * chip with a single output takes 8 KiB instead of a word per row.
+ *
+ * The rows are either owned by the table or borrowed from a read only mapping
+ * (see table_cache.hpp), which the table keeps alive.
+ */
+class TruthTable
+{
+public:
+  using Word = std::uint64_t;
+  static constexpr std::size_t WORD_BITS{ 64 };
+
+  TruthTable() = default;
+
+  static auto word_count(std::size_t input_count, std::size_t output_count) -> std::size_t
+  {
+    return ((std::size_t{ 1 } << input_count) * output_count + WORD_BITS - 1) / WORD_BITS;
+  }
+
+  /**
+   * Table reading its rows from memory owned by mapping.
+   */
+  static auto borrow(std::size_t input_count, std::size_t output_count, std::shared_ptr<const void> mapping, const Word* rows) -> TruthTable
+  {
+    TruthTable table{};
+    table.row_count = std::size_t{ 1 } << input_count;
+    table.width = output_count;
+    table.mapping = std::move(mapping);
+    table.borrowed = rows;
+    return table;
+  }
+
+  TruthTable(std::size_t input_count, std::size_t output_count)
+  : row_count(std::size_t{ 1 } << input_count)
+  , width(output_count)
+  , words(word_count(input_count, output_count), 0)
+  {
+  }
+
+  auto rows() const -> std::size_t
+  {
+    return row_count;
+  }
+
+  auto input_count() const -> std::size_t
+  {
+    return empty() ? 0 : static_cast<std::size_t>(std::countr_zero(row_count));
+  }
+
+  auto output_count() const -> std::size_t
+  {
+    return width;
+  }
+
+  auto empty() const -> bool
+  {
+    return row_count == 0;
+  }
+
+  /**
+   * Size of the packed rows in bytes.
+   */
+  auto memory() const -> std::size_t
+  {
+    return (row_count * width + WORD_BITS - 1) / WORD_BITS * sizeof(Word);
+  }
+
+  auto data() const -> const Word*
+  {
+    return (borrowed != nullptr) ? borrowed : words.data();
+  }
+
+  auto is_borrowed() const -> bool
+  {
+    return borrowed != nullptr;
+  }
+
+  auto operator[](std::size_t row) const -> std::size_t
+  {
+    if (width == 0) return 0;
+
+    const auto bit = row * width;
+    const auto word = bit / WORD_BITS;
+    const auto offset = bit % WORD_BITS;
+
+    const auto* rows = data();
+
+    Word value = rows[word] >> offset;
+    if (offset + width > WORD_BITS)
+    {
+      value |= rows[word + 1] << (WORD_BITS - offset);
+    }
+
+    return static_cast<std::size_t>(value & mask());
+  }
+
+  auto at(std::size_t row) const -> std::size_t
+  {
+    if (row >= row_count)
+    {
+      throw std::out_of_range("TruthTable: row out of range");
+    }
+    return (*this)[row];
+  }
+
+  /**
+   * Only tables owning their rows can be written to.
+   */
+  auto set(std::size_t row, std::size_t value) -> void
+  {
+    if (width == 0 || borrowed != nullptr) return;
+
+    const auto bit = row * width;
+    const auto word = bit / WORD_BITS;
+    const auto offset = bit % WORD_BITS;
+    const auto bits = static_cast<Word>(value) & mask();
+
+    words[word] = (words[word] & ~(mask() << offset)) | (bits << offset);
+    if (offset + width > WORD_BITS)
+    {
+      const auto spill = WORD_BITS - offset;
+      words[word + 1] = (words[word + 1] & ~(mask() >> spill)) | (bits >> spill);
+    }
+  }
+
+private:
+  auto mask() const -> Word
+  {
+    return (width >= WORD_BITS) ? ~Word{ 0 } : ((Word{ 1 } << width) - 1);
+  }
+
+  std::size_t                 row_count{};
+  std::size_t                 width{};
+  std::vector<Word>           words{};
+  std::shared_ptr<const void> mapping{};
+  const Word*                 borrowed{ nullptr };
+};
+
+/**
+ * How a truth table gets built (see Gate::serialize).
+ */
+struct SerializeOptions
+{
+  // Worker threads, 0 picks the hardware concurrency.
+  std::size_t                                          threads{ 0 };
+
+  // Called on the thread which started the serialization as rows complete.
+  std::function<void(std::size_t done, std::size_t rows)> progress{};
+
+  // Raised from anywhere to abandon the serialization.
+  const std::atomic<bool>*                             cancel{ nullptr };
+
+  auto cancelled() const -> bool
+  {
+    return cancel != nullptr && cancel->load(std::memory_order_relaxed);
+  }
+};
+
+#endif /* TRUTH_TABLE_H */
@@ -67,50 +67,6 @@ inline void error(std::string_view dump)
 	std::cout << "Error: " << dump << '\n';
 }
 
-template <typename ReturnType, typename DataType>
-inline std::enable_if_t<std::is_unsigned_v<ReturnType>, ReturnType> 
-bitvec_to_uint(const std::vector<DataType>& vec, const std::function<bool(const DataType&)> f, std::size_t start, std::size_t end)
-{
-	ReturnType val {0};
-
-	for (; start < end; start++)
-	{
-		val <<= 1;
-		val |= (f(vec[start])) ? 1 : 0;
-	}
-
-	return val;
-}
-
-template <typename ReturnType = std::size_t>
-inline std::enable_if_t<std::is_unsigned_v<ReturnType>, ReturnType> 
-pinvec_to_uint(const std::vector<Pin>& vec, std::size_t start, std::size_t end)
-{
-	auto pin_is_active = [](const Pin& p) { return p.is_active(); };
-	return bitvec_to_uint<ReturnType, Pin>(vec, std::move(pin_is_active), start, end);
-}
-
-template <typename T, typename VT>
-inline std::enable_if_t<std::is_unsigned_v<T>> 
-set_bitvec(T value, std::vector<VT>& target, std::function<void(VT&, bool)> f, std::size_t start, std::size_t end)
-{
-	T size = end - start;
-  for (T offset = 0; offset < size; offset++)
-  {
-		auto bit_on = (((value >> ((size-1) - offset) ) & 1) == 1);
-		f(target[start + offset], bit_on);
-  }
-}
-
-template <typename T>
-inline std::enable_if_t<std::is_unsigned_v<T>> 
-set_pinvec(T value, std::vector<Pin>& target, std::size_t start, std::size_t end)
-{
-	const auto f = [](Pin& pin, bool on){ pin.state = on ? PinState::ACTIVE : PinState::INACTIVE; };
-	set_bitvec<T, Pin>(value, target, std::move(f), start, end);
-}
-
-
 #define BLOCK "======"
 
 #endif /* UTILS_H */
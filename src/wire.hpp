@@ -36,11 +36,11 @@ struct Wire
   , output(o)
   {}
 
-  void simulate()
+  void simulate() const
   {
     if (output != nullptr)
     {
-      output->state = input->state;
+      output->set_state(input->get_state());
     }
   }
 
@@ -48,4 +48,14 @@ struct Wire
   Pin* output;
 };
 
+inline auto WireSpan::begin() const -> const Wire*
+{
+  return first;
+}
+
+inline auto WireSpan::end() const -> const Wire*
+{
+  return first + count;
+}
+
 #endif /* WIRE_H */